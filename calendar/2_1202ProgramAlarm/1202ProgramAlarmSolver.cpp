@@ -1,6 +1,14 @@
 #include <1202ProgramAlarmSolver.h>
 
+#include <IntcodeBatch.h>
 #include <IntcodeProgram.h>
+#include <IntcodeSymbolicExecutor.h>
+#include <WorkStealingThreadPool.h>
+
+#include <atomic>
+#include <limits>
+#include <map>
+#include <mutex>
 
 std::uint32_t _1202ProgramAlarmSolver::SolveProblemA() const
 {
@@ -18,24 +26,148 @@ std::uint32_t _1202ProgramAlarmSolver::SolveProblemA() const
 
 std::uint32_t _1202ProgramAlarmSolver::SolveProblemB() const
 {
-	constexpr std::uint32_t Solution = 19690720;
+	IntCodeProgramImagePtr image = IntCodeProgramRegistry::Get().Load(m_ProgramFilename);
+	if (image->IsEmpty())
+	{
+		std::cerr << "Error: couldn't process input file " << m_ProgramFilename << std::endl;
+		return 0;
+	}
+
+	std::optional<std::uint64_t> answer;
+	if (!m_IsSymbolicSolvingEnabled || !TrySolveSymbolically(image->GetProgram(), answer))
+	{
+		answer = SearchInParallel(image);
+	}
+
+	if (!answer)
+	{
+		std::cerr << "Unable to find a result for Problem 2" << std::endl;
+		return 0;
+	}
+
+	return static_cast<std::uint32_t>(*answer);
+}
+
+bool _1202ProgramAlarmSolver::TrySolveSymbolically(const IntCodeProgram& program, std::optional<std::uint64_t>& answer) const
+{
+	IntCodeSymbolicExecutor executor(program, NounAndVerb);
+	IntCodeExpressionGraph::Polynomial polynomial;
+	if (!executor.Execute() || !executor.GetGraph().TryExpand(executor.GetCell(0), polynomial))
+	{
+		return false;
+	}
 
-	// Brute force time!
-	for (std::uint32_t noun = 0; noun < 100; noun++)
+	answer.reset();
+	for (std::uint32_t noun = 0; noun < m_NounCount && (!answer || 100 * std::uint64_t(noun) < *answer); noun++)
 	{
-		for (std::uint32_t verb = 0; verb < 100; verb++)
+		// Coefficient of each power of verb, noun being known
+		std::map<std::uint32_t, IntCodeValue> coefficients;
+		for (const auto& [monomial, coefficient] : polynomial)
 		{
-			IntCodeComputer program(m_ProgramFilename);
-			program.SetNounAndVerb({ noun, verb });
-			program.Execute();
+			coefficients[monomial[1]] += coefficient * boost::multiprecision::pow(IntCodeValue(noun), monomial[0]);
+		}
 
-			if (program.GetValueAt(0) == Solution)
+		std::optional<std::uint32_t> verb;
+		const IntCodeValue constant = coefficients[0] - m_Target;
+		if (coefficients.rbegin()->first <= 1)
+		{
+			const IntCodeValue& linear = coefficients[1];
+			if (linear == 0 ? constant == 0 : constant % linear == 0 && -constant / linear >= 0 && -constant / linear < m_VerbCount)
 			{
-				return 100 * noun + verb;
+				verb = linear == 0 ? 0 : (-constant / linear).convert_to<std::uint32_t>();
 			}
 		}
+		else
+		{
+			for (std::uint32_t candidate = 0; candidate < m_VerbCount && !verb; candidate++)
+			{
+				IntCodeValue value = 0;
+				for (const auto& [power, coefficient] : coefficients)
+				{
+					value += coefficient * boost::multiprecision::pow(IntCodeValue(candidate), power);
+				}
+
+				if (value == m_Target)
+				{
+					verb = candidate;
+				}
+			}
+		}
+
+		if (verb && (!answer || 100 * std::uint64_t(noun) + *verb < *answer))
+		{
+			answer = 100 * std::uint64_t(noun) + *verb;
+		}
 	}
 
-	std::cerr << "Unable to find a result for Problem 2" << std::endl;
-	return 0;
-}
\ No newline at end of file
+	return true;
+}
+
+std::optional<std::uint64_t> _1202ProgramAlarmSolver::SearchInParallel(const IntCodeProgramImagePtr& image) const
+{
+	constexpr std::uint64_t NoAnswer = std::numeric_limits<std::uint64_t>::max();
+
+	// Up to its first access to the noun or the verb, the program runs the same for every pair
+	IntCodeComputer prefix(image);
+	prefix.ExecuteUntilAccess(NounAndVerb);
+
+	std::atomic<std::uint64_t> bestAnswer = NoAnswer;
+	std::mutex prefixMutex;
+
+	WorkStealingThreadPool pool;
+	for (std::uint32_t noun = 0; noun < m_NounCount; noun++)
+	{
+		pool.Submit([&, noun]()
+		{
+			// Some row already gave a lower answer than this one can
+			const std::uint64_t rowAnswer = 100 * std::uint64_t(noun);
+			if (rowAnswer >= bestAnswer.load(std::memory_order_relaxed))
+			{
+				return;
+			}
+
+			// Every verb runs side by side, in lockstep
+			IntCodeBatch batch(image, m_VerbCount);
+			for (std::uint32_t verb = 0; verb < m_VerbCount; verb++)
+			{
+				batch.SetNounAndVerb(verb, noun, verb);
+			}
+
+			batch.Execute();
+
+			for (std::uint32_t verb = 0; verb < m_VerbCount; verb++)
+			{
+				bool isFound = false;
+				if (batch.IsOverflowed(verb))
+				{
+					// Too big for the batch, a computer will promote itself if need be
+					IntCodeComputer program = [&]() { std::lock_guard lock(prefixMutex); return prefix.Fork(); }();
+					program.SetNounAndVerb({ noun, verb });
+					program.Execute();
+					isFound = program.GetValueAt(0) == m_Target;
+				}
+				else
+				{
+					isFound = batch.IsHalted(verb) && !batch.IsFaulted(verb) && batch.GetValueAt(verb, 0) == m_Target;
+				}
+
+				if (isFound)
+				{
+					// Verbs go up within a row: the first one found is this row's lowest
+					const std::uint64_t answer = rowAnswer + verb;
+					std::uint64_t best = bestAnswer.load(std::memory_order_relaxed);
+					while (answer < best && !bestAnswer.compare_exchange_weak(best, answer, std::memory_order_relaxed))
+					{
+					}
+
+					return;
+				}
+			}
+		});
+	}
+
+	pool.Wait();
+
+	const std::uint64_t answer = bestAnswer.load();
+	return answer != NoAnswer ? std::optional<std::uint64_t>(answer) : std::nullopt;
+}
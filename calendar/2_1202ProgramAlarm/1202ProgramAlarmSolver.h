@@ -2,6 +2,13 @@
 
 #include <ProblemSolver.h>
 
+#include <IntcodeProgramImage.h>
+#include <IntcodeValuePolicies.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
 class _1202ProgramAlarmSolver : public ProblemSolver<std::string, std::uint32_t, std::uint32_t>
 {
 public:
@@ -9,6 +16,28 @@ public:
 	std::uint32_t SolveProblemA() const override;
 	std::uint32_t SolveProblemB() const override;
 
+	// Problem B looks for the noun and verb giving the target, among nouns in [0, nounCount)
+	// and verbs in [0, verbCount). Several pairs might do: the answer is the lowest 100 * noun + verb.
+	inline void SetTarget(const IntCodeValue& target) { m_Target = target; }
+	inline void SetSearchSpace(std::uint32_t nounCount, std::uint32_t verbCount) { m_NounCount = nounCount; m_VerbCount = verbCount; }
+
+	// Without it, Problem B always searches by running the program for every pair
+	inline void SetSymbolicSolvingEnabled(bool isEnabled) { m_IsSymbolicSolvingEnabled = isEnabled; }
+
 private:
+	static constexpr std::array<IntCodeAddress, 2> NounAndVerb = { 1, 2 };
+
+	// The answer of Problem B (if there's one) from the output as a polynomial in noun and verb,
+	// given by a single symbolic run. False if the program can't be run symbolically.
+	bool TrySolveSymbolically(const IntCodeProgram& program, std::optional<std::uint64_t>& answer) const;
+
+	// Runs every pair, one row of verbs per task, until no row can give a lower answer
+	std::optional<std::uint64_t> SearchInParallel(const IntCodeProgramImagePtr& image) const;
+
 	std::string m_ProgramFilename;
-};
\ No newline at end of file
+
+	IntCodeValue m_Target = 19690720;
+	std::uint32_t m_NounCount = 100;
+	std::uint32_t m_VerbCount = 100;
+	bool m_IsSymbolicSolvingEnabled = true;
+};
@@ -1,6 +1,7 @@
 #include <SunnyWithAChanceOfAsteroidsSolver.h>
 
 #include <IntcodeProgram.h>
+#include <IntcodeResultCache.h>
 
 #include <sstream>
 
@@ -16,24 +17,38 @@ std::uint32_t SunnyWithAChanceOfAsteroidsSolver::SolveProblemB() const
 
 std::uint32_t SunnyWithAChanceOfAsteroidsSolver::SolveWithInput(std::uint32_t input) const
 {
-	IntCodeComputer program(m_InputFilename);
-	program.FeedInput(input);
-	program.Execute();
-
-	std::vector<int> output = GetOutputAsIntegers(program);
+	IntCodeProgramImagePtr image = IntCodeProgramRegistry::Get().Load(m_InputFilename);
+	if (image->IsEmpty())
+	{
+		std::cerr << "Error: can't open file " << m_InputFilename << std::endl;
+		return 0;
+	}
 
-	return static_cast<std::uint32_t>(output.back());
-}
+	// The diagnostic program only depends on its input
+	const IntCodeValue programInput = input;
+	const std::vector<IntCodeValue> output = IntCodeResultCache::Get().GetOrRun(*image, std::span(&programInput, 1), [&](std::vector<IntCodeValue>& outputs)
+	{
+		IntCodeComputer program(image);
+		program.FeedInputs(std::span(&programInput, 1));
+		program.Execute();
 
-std::vector<int> SunnyWithAChanceOfAsteroidsSolver::GetOutputAsIntegers(IntCodeComputer& program)
-{
-	std::vector<int> output;
+		outputs = GetOutputs(program);
+		return program.IsHalted();
+	});
 
-	int temp;
-	while (program.GetOutput(temp))
+	if (output.empty())
 	{
-		output.push_back(temp);
+		std::cerr << "The diagnostic program gave no output" << std::endl;
+		return 0;
 	}
 
+	return output.back().convert_to<std::uint32_t>();
+}
+
+std::vector<IntCodeValue> SunnyWithAChanceOfAsteroidsSolver::GetOutputs(IntCodeComputer& program)
+{
+	std::vector<IntCodeValue> output(program.GetOutputCount());
+	output.resize(program.DrainOutputs(std::span<IntCodeValue>(output)));
+
 	return output;
 }
\ No newline at end of file
@@ -2,9 +2,9 @@
 
 #include <ProblemSolver.h>
 
-#include <vector>
+#include <IntcodeProgram.h>
 
-class IntCodeComputer;
+#include <vector>
 
 class SunnyWithAChanceOfAsteroidsSolver : public ProblemSolver<std::string, std::uint32_t, std::uint32_t>
 {
@@ -17,5 +17,5 @@ private:
 	std::string m_InputFilename;
 
 	std::uint32_t SolveWithInput(std::uint32_t input) const;
-	static std::vector<int> GetOutputAsIntegers(IntCodeComputer& inputStream);
+	static std::vector<IntCodeValue> GetOutputs(IntCodeComputer& program);
 };
\ No newline at end of file
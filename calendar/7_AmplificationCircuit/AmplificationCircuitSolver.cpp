@@ -1,5 +1,7 @@
 #include <AmplificationCircuitSolver.h>
 
+#include <WorkStealingThreadPool.h>
+
 #include <iostream>
 #include <sstream>
 #include <algorithm>
@@ -7,68 +9,214 @@
 
 uint AmplificationCircuitSolver::SolveProblemA() const
 {
-	PermutationGenerator<uint> phaseGenerator({ 0, 1, 2, 3, 4 });
-	return InternalSolve(LoadAmplifiersFromFile(), phaseGenerator);
+	return SolveChain(m_PhasesA);
 }
 
 uint AmplificationCircuitSolver::SolveProblemB() const
 {
-	std::vector<IntCodeComputer>& amplifiers = LoadAmplifiersFromFile();
+	return SolveFeedbackLoop(m_PhasesB);
+}
+
+void AmplificationCircuitSolver::SetPhases(std::vector<uint> phasesA, std::vector<uint> phasesB)
+{
+	m_PhasesA = std::move(phasesA);
+	m_PhasesB = std::move(phasesB);
+}
 
-	for (std::size_t i = 0; i < numberOfAmplifiers; i++)
+uint AmplificationCircuitSolver::SolveChain(const std::vector<uint>& phases) const
+{
+	ChainSearch search;
+	search.m_Image = IntCodeProgramRegistry::Get().Load(m_InputFileName);
+	if (search.m_Image->IsEmpty())
 	{
-		amplifiers[i].SetPauseOnOutput(true);
+		std::cerr << "Invalid input file " << m_InputFileName << std::endl;
+		return 0;
 	}
 
-	PermutationGenerator<uint> phaseGenerator({ 5, 6, 7, 8, 9 });
-	return InternalSolve(amplifiers, phaseGenerator);
+	search.m_Phases = phases;
+	search.m_IsPhaseUsed.assign(phases.size(), false);
+
+	SearchChain(search, 0, 0);
+
+	return search.m_MaxOutput.convert_to<uint>();
 }
 
-std::vector<IntCodeComputer> AmplificationCircuitSolver::LoadAmplifiersFromFile() const
+void AmplificationCircuitSolver::SearchChain(ChainSearch& search, std::size_t depth, const IntCodeValue& signal)
 {
-	std::vector<IntCodeComputer> amplifiers;
+	if (depth == search.m_Phases.size())
+	{
+		search.m_MaxOutput = std::max(search.m_MaxOutput, signal);
+		return;
+	}
+
+	// Repeated phases lead to the same subtree, only the first one is walked
+	std::vector<uint> triedPhases;
 
-	for (std::size_t i = 0; i < numberOfAmplifiers; i++)
+	for (std::size_t i = 0; i < search.m_Phases.size(); i++)
 	{
-		IntCodeComputer& amplifier = amplifiers.emplace_back(m_InputFileName);
-		if (!amplifier.IsValid())
+		const uint phase = search.m_Phases[i];
+		if (search.m_IsPhaseUsed[i] || std::find(triedPhases.begin(), triedPhases.end(), phase) != triedPhases.end())
+		{
+			continue;
+		}
+		triedPhases.push_back(phase);
+
+		std::optional<IntCodeValue> output = RunAmplifier(search, phase, signal);
+		if (!output)
 		{
-			std::cerr << "Invalid input file " << m_InputFileName << std::endl;
-			break;
+			continue;
 		}
+
+		search.m_IsPhaseUsed[i] = true;
+		SearchChain(search, depth + 1, *output);
+		search.m_IsPhaseUsed[i] = false;
 	}
+}
 
-	return amplifiers;
+std::optional<IntCodeValue> AmplificationCircuitSolver::RunAmplifier(ChainSearch& search, uint phase, const IntCodeValue& input)
+{
+	const auto outputIt = search.m_Outputs.find({ phase, input });
+	if (outputIt != search.m_Outputs.end())
+	{
+		return outputIt->second;
+	}
+
+	auto snapshotIt = search.m_Snapshots.find(phase);
+	if (snapshotIt == search.m_Snapshots.end())
+	{
+		IntCodeComputer amplifier(search.m_Image);
+		const IntCodeValue phaseInput[] = { phase };
+		amplifier.FeedInputs(phaseInput);
+		amplifier.Execute();
+
+		snapshotIt = search.m_Snapshots.emplace(phase, std::move(amplifier)).first;
+	}
+
+	IntCodeComputer amplifier = snapshotIt->second.Fork();
+	const IntCodeValue signalInput[] = { input };
+	amplifier.FeedInputs(signalInput);
+	amplifier.Execute();
+
+	IntCodeValue output;
+	if (amplifier.DrainOutputs(std::span<IntCodeValue>(&output, 1)) == 0)
+	{
+		std::cerr << "Amplifier with phase " << phase << " gave no output" << std::endl;
+		return std::nullopt;
+	}
+
+	search.m_Outputs.emplace(std::make_pair(phase, input), output);
+	return output;
 }
 
-uint AmplificationCircuitSolver::InternalSolve(std::vector<IntCodeComputer>& amplifiers, PermutationGenerator<uint>& phaseGenerator) const
+uint AmplificationCircuitSolver::SolveFeedbackLoop(const std::vector<uint>& phases) const
 {
-	assert(phaseGenerator.GetCurrentPermutation().size() == amplifiers.size());
+	const IntCodeProgramImagePtr image = IntCodeProgramRegistry::Get().Load(m_InputFileName);
+	if (image->IsEmpty())
+	{
+		std::cerr << "Invalid input file " << m_InputFileName << std::endl;
+		return 0;
+	}
+
+	if (phases.empty())
+	{
+		return 0;
+	}
 
-	int currentInput = 0;
-	int maxOutput = 0;
+	WorkStealingThreadPool pool(m_ThreadCount);
+	PermutationGenerator<uint> phaseGenerator(phases);
 
-	const IntCodeComputer& lastAmplifier = *(amplifiers.end() - 1);
-	do
+	IntCodeValue maxOutput = 0;
+
+	std::vector<std::vector<uint>> permutations;
+	permutations.reserve(permutationsPerNetwork);
+
+	bool hasMorePermutations = true;
+	while (hasMorePermutations)
+	{
+		permutations.clear();
+		do
+		{
+			permutations.push_back(phaseGenerator.GetCurrentPermutation());
+			hasMorePermutations = phaseGenerator.ComputeNextPermutation();
+		} while (hasMorePermutations && permutations.size() < permutationsPerNetwork);
+
+		// Amplifiers of every permutation run concurrently, each one as soon as its input is there
+		const IntCodeTopology topology = BuildTopology(image, permutations);
+		IntCodeNetwork network(topology);
+		network.Run(pool);
+
+		bool isOverflowed = false;
+		for (IntCodeTopology::NodeId node = 0; node < network.GetNodeCount() && !isOverflowed; node++)
+		{
+			isOverflowed = network.GetComputer(node).IsOverflowed();
+		}
+
+		bool isHalted;
+		if (isOverflowed)
+		{
+			// Some signal doesn't fit 64 bits: the whole batch again, exactly
+			BasicIntCodeNetwork<IntCodeBigIntPolicy> bigNetwork(topology);
+			bigNetwork.Run(pool);
+			isHalted = CollectMaxOutput(bigNetwork, permutations, maxOutput);
+		}
+		else
+		{
+			isHalted = CollectMaxOutput(network, permutations, maxOutput);
+		}
+
+		if (!isHalted)
+		{
+			std::cerr << "Some feedback loops never halted" << std::endl;
+			return 0;
+		}
+	}
+
+	return maxOutput.convert_to<uint>();
+}
+
+template<typename Network>
+bool AmplificationCircuitSolver::CollectMaxOutput(const Network& network, const std::vector<std::vector<uint>>& permutations, IntCodeValue& maxOutput)
+{
+	// Otherwise some loop is stuck waiting for a signal, and its last one isn't the answer
+	if (!network.IsHalted())
+	{
+		return false;
+	}
+
+	// The answer is the last signal out of the last amplifier
+	IntCodeTopology::NodeId last = 0;
+	for (const std::vector<uint>& permutation : permutations)
 	{
-		for (std::size_t i = 0; i < amplifiers.size(); i++)
+		last += permutation.size();
+		const auto& outputs = network.GetCollectedOutputs(last - 1);
+		if (!outputs.empty())
 		{
-			amplifiers[i].Reset();
-			amplifiers[i].FeedInput(phaseGenerator.GetCurrentPermutation()[i]);
+			maxOutput = std::max(maxOutput, IntCodeValue(outputs.back()));
 		}
+	}
+
+	return true;
+}
+
+IntCodeTopology AmplificationCircuitSolver::BuildTopology(const IntCodeProgramImagePtr& image, const std::vector<std::vector<uint>>& permutations)
+{
+	IntCodeTopology topology;
 
-		currentInput = 0;
+	for (const std::vector<uint>& permutation : permutations)
+	{
+		assert(!permutation.empty());
 
-		for (std::size_t i = 0; !lastAmplifier.IsHalted(); i = (i + 1) % amplifiers.size())
+		const IntCodeTopology::NodeId first = topology.AddNode(image, { permutation[0], 0 });
+		for (std::size_t i = 1; i < permutation.size(); i++)
 		{
-			amplifiers[i].FeedInput(currentInput);
-			amplifiers[i].Execute();
-			amplifiers[i].GetOutput(currentInput);
+			const IntCodeTopology::NodeId node = topology.AddNode(image, { permutation[i] });
+			topology.Connect(node - 1, node);
 		}
 
-		int& amplifiersOutput = currentInput;
-		maxOutput = std::max(maxOutput, amplifiersOutput);
-	} while (phaseGenerator.ComputeNextPermutation());
+		const IntCodeTopology::NodeId last = first + permutation.size() - 1;
+		topology.Connect(last, first);
+		topology.CollectOutputs(last);
+	}
 
-	return maxOutput;
-}
\ No newline at end of file
+	return topology;
+}
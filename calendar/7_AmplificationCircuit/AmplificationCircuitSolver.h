@@ -1,9 +1,13 @@
 #include <ProblemSolver.h>
 
 #include <CommonDefines.h>
+#include <IntcodeNetwork.h>
 #include <IntcodeProgram.h>
 #include <PermutationGenerator.h>
 
+#include <map>
+#include <optional>
+#include <utility>
 #include <vector>
 
 class AmplificationCircuitSolver : public ProblemSolver<std::string, uint, uint>
@@ -13,12 +17,49 @@ public:
 	uint SolveProblemA() const override;
 	uint SolveProblemB() const override;
 
+	// One amplifier per phase, for both problems. Defaults to 0-4 and 5-9.
+	void SetPhases(std::vector<uint> phasesA, std::vector<uint> phasesB);
+
+	// 0 to use every core
+	inline void SetThreadCount(std::size_t threadCount) { m_ThreadCount = threadCount; }
+
 private:
-	static constexpr uint numberOfPhases = 5;
-	static constexpr std::size_t numberOfAmplifiers = 5;
+	// Permutations evaluated by one network, bounding how many amplifiers are alive at once
+	static constexpr std::size_t permutationsPerNetwork = 256;
 
 	std::string m_InputFileName;
 
-	std::vector<IntCodeComputer> LoadAmplifiersFromFile() const;
-	uint InternalSolve(std::vector<IntCodeComputer>& amplifiers, PermutationGenerator<uint>& phaseGenerator) const;
-};
\ No newline at end of file
+	std::vector<uint> m_PhasesA = { 0, 1, 2, 3, 4 };
+	std::vector<uint> m_PhasesB = { 5, 6, 7, 8, 9 };
+	std::size_t m_ThreadCount = 0;
+
+	// Without a feedback loop, permutations sharing a prefix of phases share the signals out of
+	// those first amplifiers: the permutation tree is walked depth first, so each prefix runs once
+	struct ChainSearch
+	{
+		IntCodeProgramImagePtr								m_Image;
+		std::vector<uint>									m_Phases;
+		std::vector<bool>									m_IsPhaseUsed;
+
+		// Amplifiers which got their phase and wait for their input, forked for every run
+		std::map<uint, IntCodeComputer>						m_Snapshots;
+
+		// Output of the amplifier for a phase and an input, reused whenever they come again
+		std::map<std::pair<uint, IntCodeValue>, IntCodeValue>	m_Outputs;
+
+		IntCodeValue										m_MaxOutput = 0;
+	};
+
+	uint SolveChain(const std::vector<uint>& phases) const;
+	static void SearchChain(ChainSearch& search, std::size_t depth, const IntCodeValue& signal);
+	static std::optional<IntCodeValue> RunAmplifier(ChainSearch& search, uint phase, const IntCodeValue& input);
+
+	uint SolveFeedbackLoop(const std::vector<uint>& phases) const;
+
+	// False if some amplifier didn't halt
+	template<typename Network>
+	static bool CollectMaxOutput(const Network& network, const std::vector<std::vector<uint>>& permutations, IntCodeValue& maxOutput);
+
+	// Every permutation gets its own ring of amplifiers, all in the same topology
+	static IntCodeTopology BuildTopology(const IntCodeProgramImagePtr& image, const std::vector<std::vector<uint>>& permutations);
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <IntcodeProgram.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// The SIMD (or not) implementation of the instructions run together, see IntcodeBatch.cpp
+struct IntCodeBatchKernels;
+
+/***********************************************************************************************
+
+ Runs many instances of the same IntCode program side by side, on 64 bit integers.
+
+ Memory is laid out address first, so that a cell holds the value of every instance next
+ to each other. At each step the batch picks the lowest instruction pointer and executes
+ that instruction for every instance sitting there: when the instruction is the same for
+ all of them (which is the common case, even if the data differ) ADD, MUL, LT, EQ, JT and
+ JF are executed on all instances at once with SIMD instructions (AVX2 if the CPU has it).
+ Instances whose control flow or code diverge are executed one by one, and join the others
+ again whenever they meet at the same instruction.
+
+ An instance is stopped as Overflowed whenever it would need more than the batch offers:
+ values wider than 64 bits, or writes beyond the memory size of the batch. Run it on an
+ IntCodeComputer instead. Instances running into an invalid instruction or address are
+ stopped as Halted, and flagged as faulted.
+
+************************************************************************************************/
+
+class IntCodeBatch : public IntCodeDefinitions
+{
+public:
+	enum class InstructionSet
+	{
+		Scalar,
+		Avx2
+	};
+
+	// The best the running CPU supports
+	static InstructionSet GetBestInstructionSet();
+
+	// A memorySize of 0 only gives the instances as much memory as the program itself
+	IntCodeBatch(IntCodeProgramImagePtr image, std::size_t instanceCount, std::size_t memorySize = 0);
+	IntCodeBatch(IntCodeProgramImagePtr image, std::size_t instanceCount, std::size_t memorySize, InstructionSet instructionSet);
+
+	void Reset();
+	void Execute();
+
+	void SetNounAndVerb(std::size_t instance, std::int64_t noun, std::int64_t verb);
+	void StoreValue(std::size_t instance, IntCodeAddress address, std::int64_t value);
+	void FeedInputs(std::size_t instance, std::span<const std::int64_t> inputs);
+
+	std::int64_t GetValueAt(std::size_t instance, IntCodeAddress address) const;
+	inline const std::vector<std::int64_t>& GetOutputs(std::size_t instance) const { return m_Outputs[instance]; }
+
+	inline ExecutionStatus GetStatus(std::size_t instance) const { return m_Statuses[instance]; }
+	inline bool IsHalted(std::size_t instance) const { return m_Statuses[instance] == ExecutionStatus::Halted; }
+	inline bool IsOverflowed(std::size_t instance) const { return m_Statuses[instance] == ExecutionStatus::Overflowed; }
+	inline bool IsFaulted(std::size_t instance) const { return m_Faulted[instance]; }
+
+	inline std::size_t GetInstanceCount() const { return m_InstanceCount; }
+	inline InstructionSet GetInstructionSet() const { return m_InstructionSet; }
+
+private:
+	inline std::int64_t* GetRow(std::int64_t address) { return m_Memory.data() + static_cast<std::size_t>(address) * m_LaneCount; }
+	inline const std::int64_t* GetRow(std::int64_t address) const { return m_Memory.data() + static_cast<std::size_t>(address) * m_LaneCount; }
+
+	bool TryExecuteTogether(std::int64_t instructionPointer);
+	void ExecuteAlone(std::size_t lane);
+	void Stop(std::size_t lane, ExecutionStatus status, bool faulted = false);
+
+	bool ReadLane(std::size_t lane, std::int64_t address, std::int64_t& value) const;
+
+	IntCodeProgramImagePtr		m_Image;
+	const IntCodeBatchKernels*	m_Kernels;
+	InstructionSet				m_InstructionSet;
+
+	std::size_t					m_InstanceCount;
+	std::size_t					m_LaneCount;
+	std::int64_t				m_MemorySize;
+
+	// m_MemorySize rows of m_LaneCount values
+	std::vector<std::int64_t>	m_Memory;
+
+	// One per lane. Masks are -1 for the selected lanes and 0 otherwise, like SIMD masks.
+	std::vector<std::int64_t>	m_InstructionPointers;
+	std::vector<std::int64_t>	m_RelativeBases;
+	std::vector<std::int64_t>	m_RunningMask;
+	std::vector<std::int64_t>	m_StepMask;
+
+	std::vector<ExecutionStatus>			m_Statuses;
+	std::vector<bool>						m_Faulted;
+	std::vector<std::vector<std::int64_t>>	m_Inputs;
+	std::vector<std::size_t>				m_ReadInputs;
+	std::vector<std::vector<std::int64_t>>	m_Outputs;
+};
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <utility>
+
+/***********************************************************************************************
+
+ A bounded FIFO of IntCode values, used for the input and output of IntCode computers.
+
+ Lock-free as long as there is a single producer and a single consumer, which may live on
+ different threads: that's enough to plug the output of a computer into the input of
+ another one. Everything else (Clear, ForEachPending) must only be called while nobody is
+ pushing or popping.
+
+************************************************************************************************/
+
+template<typename T>
+class IntCodeChannel
+{
+public:
+	static constexpr std::size_t DefaultCapacity = 256;
+
+	// The capacity is rounded up to a power of two
+	explicit IntCodeChannel(std::size_t capacity = DefaultCapacity);
+
+	IntCodeChannel(const IntCodeChannel& other) = delete;
+	IntCodeChannel& operator=(const IntCodeChannel& other) = delete;
+
+	// Producer side
+	bool TryPush(T value);
+	std::size_t Push(std::span<const T> values);
+
+	// Consumer side
+	const T* Front();
+	void PopFront();
+	bool TryPop(T& value);
+	std::size_t Pop(std::span<T> values);
+
+	void Clear();
+
+	template<typename Visitor>
+	void ForEachPending(Visitor visitor) const;
+
+	inline std::size_t GetCapacity() const { return m_Mask + 1; }
+
+	// Exact only when called by either end, otherwise just a snapshot
+	inline std::size_t GetSize() const { return m_Tail.load(std::memory_order_acquire) - m_Head.load(std::memory_order_acquire); }
+	inline bool IsEmpty() const { return GetSize() == 0; }
+
+	// How many values went through each end since the channel was created.
+	// Exact when called by that end, so each end can tell how much it moved.
+	inline std::size_t GetPushedCount() const { return m_Tail.load(std::memory_order_acquire); }
+	inline std::size_t GetPoppedCount() const { return m_Head.load(std::memory_order_acquire); }
+
+private:
+	static constexpr std::size_t CacheLineSize = 64;
+
+	static std::size_t RoundUpToPowerOfTwo(std::size_t value);
+
+	// Indices only ever grow, and are masked on access
+	alignas(CacheLineSize) std::atomic<std::size_t>	m_Head { 0 };
+	std::size_t										m_CachedTail = 0;
+
+	alignas(CacheLineSize) std::atomic<std::size_t>	m_Tail { 0 };
+	std::size_t										m_CachedHead = 0;
+
+	alignas(CacheLineSize) std::size_t				m_Mask;
+	std::unique_ptr<T[]>							m_Buffer;
+};
+
+template<typename T>
+using IntCodeChannelPtr = std::shared_ptr<IntCodeChannel<T>>;
+
+template<typename T>
+IntCodeChannel<T>::IntCodeChannel(std::size_t capacity)
+	: m_Mask(RoundUpToPowerOfTwo(capacity) - 1)
+	, m_Buffer(new T[m_Mask + 1])
+{
+}
+
+template<typename T>
+std::size_t IntCodeChannel<T>::RoundUpToPowerOfTwo(std::size_t value)
+{
+	std::size_t powerOfTwo = 1;
+	while (powerOfTwo < value)
+	{
+		powerOfTwo <<= 1;
+	}
+
+	return powerOfTwo;
+}
+
+template<typename T>
+bool IntCodeChannel<T>::TryPush(T value)
+{
+	const std::size_t tail = m_Tail.load(std::memory_order_relaxed);
+	if (tail - m_CachedHead > m_Mask)
+	{
+		m_CachedHead = m_Head.load(std::memory_order_acquire);
+		if (tail - m_CachedHead > m_Mask)
+		{
+			return false;
+		}
+	}
+
+	m_Buffer[tail & m_Mask] = std::move(value);
+	m_Tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+template<typename T>
+std::size_t IntCodeChannel<T>::Push(std::span<const T> values)
+{
+	const std::size_t tail = m_Tail.load(std::memory_order_relaxed);
+	if (tail - m_CachedHead + values.size() > GetCapacity())
+	{
+		m_CachedHead = m_Head.load(std::memory_order_acquire);
+	}
+
+	const std::size_t count = std::min(values.size(), GetCapacity() - (tail - m_CachedHead));
+	for (std::size_t i = 0; i < count; i++)
+	{
+		m_Buffer[(tail + i) & m_Mask] = values[i];
+	}
+
+	m_Tail.store(tail + count, std::memory_order_release);
+	return count;
+}
+
+template<typename T>
+const T* IntCodeChannel<T>::Front()
+{
+	const std::size_t head = m_Head.load(std::memory_order_relaxed);
+	if (head == m_CachedTail)
+	{
+		m_CachedTail = m_Tail.load(std::memory_order_acquire);
+		if (head == m_CachedTail)
+		{
+			return nullptr;
+		}
+	}
+
+	return &m_Buffer[head & m_Mask];
+}
+
+template<typename T>
+void IntCodeChannel<T>::PopFront()
+{
+	assert(Front() != nullptr);
+	m_Head.store(m_Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template<typename T>
+bool IntCodeChannel<T>::TryPop(T& value)
+{
+	const std::size_t head = m_Head.load(std::memory_order_relaxed);
+	if (head == m_CachedTail)
+	{
+		m_CachedTail = m_Tail.load(std::memory_order_acquire);
+		if (head == m_CachedTail)
+		{
+			return false;
+		}
+	}
+
+	value = std::move(m_Buffer[head & m_Mask]);
+	m_Head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+template<typename T>
+std::size_t IntCodeChannel<T>::Pop(std::span<T> values)
+{
+	const std::size_t head = m_Head.load(std::memory_order_relaxed);
+	if (m_CachedTail - head < values.size())
+	{
+		m_CachedTail = m_Tail.load(std::memory_order_acquire);
+	}
+
+	const std::size_t count = std::min(values.size(), m_CachedTail - head);
+	for (std::size_t i = 0; i < count; i++)
+	{
+		values[i] = std::move(m_Buffer[(head + i) & m_Mask]);
+	}
+
+	m_Head.store(head + count, std::memory_order_release);
+	return count;
+}
+
+template<typename T>
+void IntCodeChannel<T>::Clear()
+{
+	const std::size_t tail = m_Tail.load(std::memory_order_acquire);
+	m_Head.store(tail, std::memory_order_release);
+	m_CachedHead = m_CachedTail = tail;
+}
+
+template<typename T>
+template<typename Visitor>
+void IntCodeChannel<T>::ForEachPending(Visitor visitor) const
+{
+	const std::size_t tail = m_Tail.load(std::memory_order_acquire);
+	for (std::size_t index = m_Head.load(std::memory_order_acquire); index != tail; index++)
+	{
+		visitor(m_Buffer[index & m_Mask]);
+	}
+}
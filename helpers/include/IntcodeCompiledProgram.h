@@ -0,0 +1,116 @@
+#pragma once
+
+#include <IntcodeProgram.h>
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+/***********************************************************************************************
+
+ The runtime of an IntCode program translated into C++ ahead of time, see the
+ IntcodeTranslator tool and the add_intcode_program CMake function.
+
+ Translated code runs on 64 bit integers, over a fixed amount of memory, with the
+ instructions of the original program baked in. Whenever that isn't enough (an overflow,
+ a write past the memory or over the program's own code, a jump where the translator
+ didn't expect one) the program is handed over to an IntCodeComputer for good, which
+ resumes it from that very instruction.
+
+ Offers the same interface as IntCodeComputer.
+
+************************************************************************************************/
+
+class IntCodeCompiledProgram : public IntCodeDefinitions
+{
+public:
+	IntCodeCompiledProgram(const IntCodeCompiledProgram& other) = delete;
+	IntCodeCompiledProgram& operator=(const IntCodeCompiledProgram& other) = delete;
+
+	virtual ~IntCodeCompiledProgram() = default;
+
+	void SetNounAndVerb(InitData init);
+	void Reset();
+	void Execute();
+
+	// See IntCodeComputer
+	std::size_t FeedInputs(std::span<const std::int64_t> inputs);
+	std::size_t FeedInputs(std::span<const IntCodeValue> inputs);
+	std::size_t DrainOutputs(std::span<std::int64_t> outputs);
+	std::size_t DrainOutputs(std::span<IntCodeValue> outputs);
+	std::size_t GetOutputCount() const;
+
+	inline bool IsValid() const { return true; }
+	inline bool IsHalted() const { return m_Interpreter ? m_Interpreter->IsHalted() : m_Status == ExecutionStatus::Halted; }
+	inline bool IsPaused() const { return m_Interpreter ? m_Interpreter->IsPaused() : m_Status == ExecutionStatus::Paused; }
+	inline bool IsAwaitingInput() const { return m_Interpreter ? m_Interpreter->IsAwaitingInput() : m_Status == ExecutionStatus::AwaitingInput; }
+	IntCodeValue GetValueAt(IntCodeAddress address) const;
+
+	// True once the translated code had to give up on the program
+	inline bool IsInterpreted() const { return m_Interpreter.has_value(); }
+
+protected:
+	enum class NativeExit
+	{
+		Halt,
+		AwaitInput,
+		Block,
+		Interpret
+	};
+
+	// isCode tells which addresses of the program the translated code relies on
+	IntCodeCompiledProgram(std::span<const std::int64_t> program, std::span<const bool> isCode, std::size_t memorySize);
+
+	// Runs from m_InstructionPointer, and leaves it (and m_RelativeBase) on the instruction it stopped at
+	virtual NativeExit RunNative() = 0;
+
+	// For relative accesses of the translated code. Reads past the memory give 0, like with the
+	// interpreter. Negative addresses, and writes past the memory or to code, are left to the interpreter.
+	inline bool TryRead(std::int64_t relativeBase, std::int64_t offset, std::int64_t& value) const
+	{
+		std::int64_t address;
+		if (!IntCodeInt64Policy::TryAdd(relativeBase, offset, address) || address < 0)
+		{
+			return false;
+		}
+
+		value = static_cast<std::size_t>(address) < m_Memory.size() ? m_Memory[address] : 0;
+		return true;
+	}
+
+	inline bool TryWrite(std::int64_t relativeBase, std::int64_t offset, std::int64_t value)
+	{
+		std::int64_t address;
+		if (!IntCodeInt64Policy::TryAdd(relativeBase, offset, address) || address < 0 || static_cast<std::size_t>(address) >= m_Memory.size())
+		{
+			return false;
+		}
+
+		if (static_cast<std::size_t>(address) < m_IsCode.size() && m_IsCode[address])
+		{
+			return false;
+		}
+
+		m_Memory[address] = value;
+		return true;
+	}
+
+	std::vector<std::int64_t>		m_Memory;
+	std::int64_t					m_InstructionPointer = 0;
+	std::int64_t					m_RelativeBase = 0;
+
+	IntCodeChannelPtr<std::int64_t>	m_InputChannel;
+	IntCodeChannelPtr<std::int64_t>	m_OutputChannel;
+
+private:
+	void StartInterpreter();
+
+	std::span<const std::int64_t>	m_Program;
+	std::span<const bool>			m_IsCode;
+
+	ExecutionStatus					m_Status = ExecutionStatus::NotStarted;
+	bool							m_HasModifiedCode = false;
+
+	std::optional<IntCodeComputer>	m_Interpreter;
+};
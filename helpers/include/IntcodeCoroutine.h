@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cassert>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <utility>
+
+/***********************************************************************************************
+
+ An IntCode computer running as a C++20 coroutine (see BasicIntCodeComputer::Run).
+
+ The coroutine co_yields every output, and co_awaits whenever the computer needs an input
+ nobody sent yet. It never spins: while suspended it costs nothing, so any number of
+ computers can be interleaved by a single thread, resuming only the ones that can progress.
+
+	IntCodeCoroutine<IntCodeValue> routine = computer.Run();
+	routine.Send(input);
+	while (std::optional<IntCodeValue> output = routine.Receive()) { ... }
+
+ The computer must outlive the coroutine, and must not be moved while it runs.
+
+************************************************************************************************/
+
+template<typename T>
+class IntCodeCoroutine
+{
+public:
+	// co_await this from the coroutine body to get the next input
+	struct InputRequest {};
+
+	struct promise_type
+	{
+		struct InputAwaiter
+		{
+			promise_type& m_Promise;
+
+			inline bool await_ready() const { return !m_Promise.m_Inputs.empty(); }
+			inline void await_suspend(std::coroutine_handle<promise_type>) { m_Promise.m_AwaitingInput = true; }
+
+			T await_resume()
+			{
+				T input = std::move(m_Promise.m_Inputs.front());
+				m_Promise.m_Inputs.pop_front();
+				return input;
+			}
+		};
+
+		inline IntCodeCoroutine get_return_object() { return IntCodeCoroutine(std::coroutine_handle<promise_type>::from_promise(*this)); }
+		inline std::suspend_always initial_suspend() noexcept { return {}; }
+		inline std::suspend_always final_suspend() noexcept { return {}; }
+		inline void return_void() {}
+		inline void unhandled_exception() { m_Exception = std::current_exception(); }
+
+		inline std::suspend_always yield_value(T output)
+		{
+			m_Output = std::move(output);
+			return {};
+		}
+
+		inline InputAwaiter await_transform(InputRequest) { return InputAwaiter { *this }; }
+
+		std::deque<T>		m_Inputs;
+		std::optional<T>	m_Output;
+		bool				m_AwaitingInput = false;
+		std::exception_ptr	m_Exception;
+	};
+
+	IntCodeCoroutine(const IntCodeCoroutine& other) = delete;
+	IntCodeCoroutine& operator=(const IntCodeCoroutine& other) = delete;
+
+	IntCodeCoroutine(IntCodeCoroutine&& other) noexcept : m_Handle(std::exchange(other.m_Handle, nullptr)) {}
+
+	IntCodeCoroutine& operator=(IntCodeCoroutine&& other) noexcept
+	{
+		std::swap(m_Handle, other.m_Handle);
+		return *this;
+	}
+
+	~IntCodeCoroutine()
+	{
+		if (m_Handle)
+		{
+			m_Handle.destroy();
+		}
+	}
+
+	// Queues an input, resuming the computer if it was waiting for one
+	void Send(T input);
+
+	// The next output, running the computer until it produces one.
+	// Empty if the computer stopped without outputting: see IsAwaitingInput and IsDone.
+	std::optional<T> Receive();
+
+	inline bool IsAwaitingInput() const { return m_Handle.promise().m_AwaitingInput; }
+	inline bool IsDone() const { return m_Handle.done(); }
+
+private:
+	explicit IntCodeCoroutine(std::coroutine_handle<promise_type> handle) : m_Handle(handle) {}
+
+	void Resume();
+
+	std::coroutine_handle<promise_type> m_Handle;
+};
+
+template<typename T>
+void IntCodeCoroutine<T>::Send(T input)
+{
+	promise_type& promise = m_Handle.promise();
+	promise.m_Inputs.push_back(std::move(input));
+
+	if (promise.m_AwaitingInput)
+	{
+		Resume();
+	}
+}
+
+template<typename T>
+std::optional<T> IntCodeCoroutine<T>::Receive()
+{
+	promise_type& promise = m_Handle.promise();
+	if (!promise.m_Output && !promise.m_AwaitingInput && !m_Handle.done())
+	{
+		Resume();
+	}
+
+	return std::exchange(promise.m_Output, std::nullopt);
+}
+
+template<typename T>
+void IntCodeCoroutine<T>::Resume()
+{
+	promise_type& promise = m_Handle.promise();
+	promise.m_AwaitingInput = false;
+
+	m_Handle.resume();
+
+	if (promise.m_Exception)
+	{
+		std::rethrow_exception(std::exchange(promise.m_Exception, nullptr));
+	}
+}
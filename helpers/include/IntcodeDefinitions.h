@@ -0,0 +1,124 @@
+#pragma once
+
+#include <IntcodeValuePolicies.h>
+
+#include <cstddef>
+
+// Types shared by every IntCode computer, regardless of its ValuePolicy
+class IntCodeDefinitions
+{
+public:
+	enum class ExecutionProgress
+	{
+		Continue,
+		Jump,
+		Pause,
+		Block,
+		AwaitInput,
+		Overflow,
+		Halt
+	};
+
+	enum class ExecutionStatus
+	{
+		NotStarted,
+		Running,
+		Paused,
+		Preempted,
+		AwaitingInput,
+		Overflowed,
+		Halted
+	};
+
+	struct InitData
+	{
+		IntCodeValue noun;
+		IntCodeValue verb;
+	};
+
+	enum class OpCode : int
+	{
+		ADD = 1,
+		MUL = 2,
+		IN_ = 3,
+		OU_ = 4,
+		JT_ = 5,
+		JF_ = 6,
+		LT_ = 7,
+		EQU = 8,
+		RBS = 9,
+		HLT = 99
+	};
+
+	enum class ParameterMode : int
+	{
+		POS = 0,
+		IMM = 1,
+		REL = 2
+	};
+
+	// Longest instruction, opcode included
+	static constexpr std::size_t MaxInstructionLength = 4;
+
+	static constexpr std::size_t GetParameterCount(OpCode opCode)
+	{
+		switch (opCode)
+		{
+		case OpCode::ADD:
+		case OpCode::MUL:
+		case OpCode::LT_:
+		case OpCode::EQU:
+			return 3;
+		case OpCode::JT_:
+		case OpCode::JF_:
+			return 2;
+		case OpCode::IN_:
+		case OpCode::OU_:
+		case OpCode::RBS:
+			return 1;
+		case OpCode::HLT:
+		default:
+			return 0;
+		}
+	}
+
+	// Index of the parameter an instruction writes to, MaxInstructionLength if it doesn't write
+	static constexpr std::size_t GetStoredParameter(OpCode opCode)
+	{
+		switch (opCode)
+		{
+		case OpCode::ADD:
+		case OpCode::MUL:
+		case OpCode::LT_:
+		case OpCode::EQU:
+			return 2;
+		case OpCode::IN_:
+			return 0;
+		default:
+			return MaxInstructionLength;
+		}
+	}
+
+	static constexpr const char* GetOpCodeName(OpCode opCode)
+	{
+		switch (opCode)
+		{
+		case OpCode::ADD: return "ADD";
+		case OpCode::MUL: return "MUL";
+		case OpCode::IN_: return "IN";
+		case OpCode::OU_: return "OUT";
+		case OpCode::JT_: return "JT";
+		case OpCode::JF_: return "JF";
+		case OpCode::LT_: return "LT";
+		case OpCode::EQU: return "EQ";
+		case OpCode::RBS: return "RBS";
+		case OpCode::HLT: return "HLT";
+		default: return "???";
+		}
+	}
+
+	static constexpr bool IsValidOpCode(int opCode)
+	{
+		return (opCode >= static_cast<int>(OpCode::ADD) && opCode <= static_cast<int>(OpCode::RBS)) || opCode == static_cast<int>(OpCode::HLT);
+	}
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <IntcodeDefinitions.h>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <set>
+#include <vector>
+
+/***********************************************************************************************
+
+ Finds the code of an IntCode program without running it, and builds its control flow graph.
+
+ Instructions are found by following the control flow from address 0, and from every
+ immediate value that looks like a return address (as long as it decodes to something which
+ doesn't overlap known code or data). They are then split into basic blocks.
+
+ Besides the graph, the disassembler reports what makes a program hard to run fast: writes
+ over its own code, writes through the relative base (which could land anywhere), computed
+ jumps, and the I/O sites. Each cell of the program is classified as code, data, or unknown.
+
+ Everything is static: a program which writes code and jumps to it, or jumps through a table,
+ can run instructions that aren't listed here. IsCodeStatic tells when that can't happen.
+
+************************************************************************************************/
+
+class IntCodeDisassembler : public IntCodeDefinitions
+{
+public:
+	struct Instruction
+	{
+		OpCode							m_OpCode;
+		std::size_t						m_Length;
+		std::array<ParameterMode, 3>	m_Modes;
+		std::array<IntCodeValue, 3>		m_Parameters;
+	};
+
+	struct BasicBlock
+	{
+		// First instruction, and one past the last cell of the last instruction
+		IntCodeAddress					m_Begin;
+		IntCodeAddress					m_End;
+
+		std::vector<IntCodeAddress>		m_Instructions;
+
+		// Blocks control can go to from this one, and come from. Constant conditions are folded.
+		std::vector<IntCodeAddress>		m_Successors;
+		std::vector<IntCodeAddress>		m_Predecessors;
+
+		// Ends with a computed jump, or goes somewhere no instruction was found
+		bool							m_HasUnknownSuccessor = false;
+	};
+
+	enum class CellKind : std::uint8_t
+	{
+		Unknown,		// Neither run nor accessed at a fixed address: padding, or only reached through the relative base
+		Data,			// Read or written at a fixed address, never run
+		Code,			// Part of an instruction, never written at a fixed address
+		ModifiedCode	// Part of an instruction, and written at a fixed address
+	};
+
+	explicit IntCodeDisassembler(const IntCodeProgram& program);
+
+	inline std::size_t GetProgramSize() const { return m_CellKinds.size(); }
+
+	inline const std::map<IntCodeAddress, Instruction>& GetInstructions() const { return m_Instructions; }
+	const Instruction* FindInstruction(IntCodeAddress address) const;
+
+	// Keyed by the address of their first instruction
+	inline const std::map<IntCodeAddress, BasicBlock>& GetBasicBlocks() const { return m_BasicBlocks; }
+
+	// The block with an instruction starting or running over the given address, if any
+	const BasicBlock* FindBasicBlock(IntCodeAddress address) const;
+
+	// Unknown past the program
+	CellKind GetCellKind(IntCodeAddress address) const;
+	inline bool IsCode(IntCodeAddress address) const { const CellKind kind = GetCellKind(address); return kind == CellKind::Code || kind == CellKind::ModifiedCode; }
+
+	// Addresses of the instructions doing each, in order
+	inline const std::vector<IntCodeAddress>& GetSelfModifyingWrites() const { return m_SelfModifyingWrites; }
+	inline const std::vector<IntCodeAddress>& GetRelativeWrites() const { return m_RelativeWrites; }
+	inline const std::vector<IntCodeAddress>& GetIndirectJumps() const { return m_IndirectJumps; }
+	inline const std::vector<IntCodeAddress>& GetInputSites() const { return m_InputSites; }
+	inline const std::vector<IntCodeAddress>& GetOutputSites() const { return m_OutputSites; }
+
+	// Code is never written, and every jump goes to an instruction found: those are the only
+	// ones the program can ever run, unless something outside writes to its memory
+	bool IsCodeStatic() const;
+
+	// Code is static and does no I/O: the program always computes the same thing
+	inline bool IsIoFree() const { return IsCodeStatic() && m_InputSites.empty() && m_OutputSites.empty(); }
+
+	// "ADD [225], 6, [rb+3]"
+	static void WriteInstruction(std::ostream& output, const Instruction& instruction);
+
+	// Every cell of the program, as instructions split in blocks or as data
+	void WriteListing(std::ostream& output) const;
+
+private:
+	bool TryDecode(IntCodeAddress address, Instruction& instruction) const;
+
+	// Decodes everything reachable from the given address. With a tentative root, fails
+	// (and decodes nothing) if that would clash with what is already known.
+	bool Discover(IntCodeAddress root, bool isTentative);
+
+	void BuildBasicBlocks();
+	void ClassifyCells();
+
+	// Address a fixed parameter refers to, if it is within the program
+	bool TryGetProgramAddress(const IntCodeValue& parameter, IntCodeAddress& address) const;
+
+	IntCodeProgram							m_Program;
+
+	std::map<IntCodeAddress, Instruction>	m_Instructions;
+	std::map<IntCodeAddress, BasicBlock>	m_BasicBlocks;
+	std::vector<CellKind>					m_CellKinds;
+
+	// Addresses written at a fixed address during discovery, which can't be code
+	std::set<IntCodeAddress>				m_DataAddresses;
+
+	std::vector<IntCodeAddress>				m_SelfModifyingWrites;
+	std::vector<IntCodeAddress>				m_RelativeWrites;
+	std::vector<IntCodeAddress>				m_IndirectJumps;
+	std::vector<IntCodeAddress>				m_InputSites;
+	std::vector<IntCodeAddress>				m_OutputSites;
+};
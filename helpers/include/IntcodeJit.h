@@ -0,0 +1,95 @@
+#pragma once
+
+#include <IntcodeProgram.h>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__unix__)
+#define INTCODE_HAS_JIT 1
+#else
+#define INTCODE_HAS_JIT 0
+#endif
+
+/***********************************************************************************************
+
+ Compiles the hot loops of a 64 bit IntCode program into x86-64 machine code.
+
+ The interpreter reports every jump it takes. Backward jumps are counted per target, and
+ once a target gets hot, the code from there is compiled into a region: every arithmetic,
+ comparison, jump and relative base instruction reachable without leaving a window of
+ addresses. Jumps within the region stay native, computed ones included.
+
+ Anything else leaves the region, and the interpreter carries on from that instruction:
+ I/O, halts, jumps elsewhere, and every guard that fails on the way (an overflow, a write
+ over the region's own code, an address the region can't reach directly, a write to a
+ page still shared with a fork). Regions get thrown away as soon as their code changes.
+
+ Only available on x86-64 Unix, elsewhere nothing ever gets compiled.
+
+************************************************************************************************/
+
+class IntCodeJit : public IntCodeDefinitions
+{
+public:
+	using Memory = IntCodeMemory<IntCodeInt64Policy>;
+
+	static constexpr bool IsSupported() { return INTCODE_HAS_JIT != 0; }
+
+	// Backward jumps to an address before it gets compiled
+	static constexpr std::uint32_t HotThreshold = 64;
+
+	// programSize covers whatever the interpreter caches decoded instructions for
+	explicit IntCodeJit(std::size_t programSize);
+	~IntCodeJit();
+
+	IntCodeJit(const IntCodeJit& other);
+	IntCodeJit& operator=(const IntCodeJit& other) = delete;
+
+	// Called by the interpreter for every jump it takes. Returns true if compiled code ran:
+	// the instruction pointer and relative base are then on the instruction to go on with.
+	// hasWrittenProgram tells whether compiled code wrote within the program or any region.
+	bool TryRun(Memory& memory, IntCodeAddress jumpSource, IntCodeAddress& instructionPointer, std::int64_t& relativeBase, bool& hasWrittenProgram);
+
+	// The interpreter wrote at this address
+	void OnStore(IntCodeAddress address);
+
+	// Throws away the regions whose code doesn't match the memory anymore
+	void Revalidate(const Memory& memory);
+
+	inline std::size_t GetRegionCount() const { return m_Regions.size(); }
+
+private:
+	struct Region;
+
+	bool TryCompile(const Memory& memory, IntCodeAddress entryAddress);
+	void UpdateRegions();
+
+	std::size_t										m_ProgramSize;
+
+	// Shared with forks, never modified once compiled
+	std::vector<std::shared_ptr<const Region>>		m_Regions;
+
+	// Where each address compiled as an instruction starts, in which region
+	struct EntryPoint
+	{
+		const Region*	m_Region;
+		const void*		m_Code;
+	};
+
+	std::unordered_map<IntCodeAddress, EntryPoint>	m_EntryPoints;
+	std::unordered_map<IntCodeAddress, std::uint32_t>	m_BackwardJumps;
+
+	// Runs which left right away, per entry address: past a few, the entry point is dropped
+	std::unordered_map<IntCodeAddress, std::uint32_t>	m_StalledRuns;
+
+	// Union of every region's code
+	IntCodeAddress									m_CodeBegin = 0;
+	IntCodeAddress									m_CodeEnd = 0;
+
+	// Reused by every run
+	std::vector<const std::int64_t*>				m_ReadablePages;
+	std::vector<std::int64_t*>						m_WritablePages;
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <IntcodeProgram.h>
+#include <WorkStealingThreadPool.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+/***********************************************************************************************
+
+ Describes a network of IntCode computers: which program each one runs, what it gets as
+ input before anything else, and whose output goes to whose input.
+
+ A computer can send to many (each receives every output) and receive from many (outputs
+ are merged in no particular order). Outputs of computers sending nowhere are collected,
+ and so are those of any computer marked with CollectOutputs.
+
+************************************************************************************************/
+
+class IntCodeTopology
+{
+public:
+	using NodeId = std::size_t;
+
+	struct Node
+	{
+		IntCodeProgramImagePtr		m_Image;
+		std::vector<IntCodeValue>	m_InitialInputs;
+		bool						m_CollectsOutputs = false;
+	};
+
+	struct Edge
+	{
+		NodeId m_From;
+		NodeId m_To;
+	};
+
+	// Each computer of the chain sends to the next one
+	static IntCodeTopology Chain(const IntCodeProgramImagePtr& image, std::size_t length);
+
+	// A chain whose last computer sends back to the first one
+	static IntCodeTopology Ring(const IntCodeProgramImagePtr& image, std::size_t length);
+
+	NodeId AddNode(IntCodeProgramImagePtr image, std::vector<IntCodeValue> initialInputs = {});
+	void Connect(NodeId from, NodeId to);
+
+	void SetInitialInputs(NodeId node, std::vector<IntCodeValue> initialInputs);
+	void CollectOutputs(NodeId node);
+
+	inline const std::vector<Node>& GetNodes() const { return m_Nodes; }
+	inline const std::vector<Edge>& GetEdges() const { return m_Edges; }
+
+private:
+	std::vector<Node> m_Nodes;
+	std::vector<Edge> m_Edges;
+};
+
+/***********************************************************************************************
+
+ Runs an IntCodeTopology on a WorkStealingThreadPool.
+
+ Every computer is a task, running until it needs an input nobody produced yet, or until
+ whoever it sends to can't take more. Then it parks, and it's scheduled again as soon as
+ another computer makes progress that concerns it. Computers talking to a single peer
+ share the channel with it, others go through one channel per connection.
+
+ Run returns once every computer either halted or is waiting on some other computer which
+ can't progress either.
+
+************************************************************************************************/
+
+template<typename ValuePolicy>
+class BasicIntCodeNetwork
+{
+public:
+	using Value = typename ValuePolicy::Value;
+	using Computer = BasicIntCodeComputer<ValuePolicy>;
+	using NodeId = IntCodeTopology::NodeId;
+
+	explicit BasicIntCodeNetwork(const IntCodeTopology& topology);
+
+	BasicIntCodeNetwork(const BasicIntCodeNetwork& other) = delete;
+	BasicIntCodeNetwork& operator=(const BasicIntCodeNetwork& other) = delete;
+
+	// Not while running
+	std::size_t FeedInputs(NodeId node, std::span<const Value> inputs);
+
+	void Run(WorkStealingThreadPool& pool);
+
+	bool IsHalted() const;
+
+	inline std::size_t GetNodeCount() const { return m_Nodes.size(); }
+	inline const Computer& GetComputer(NodeId node) const { return m_Nodes[node]->m_Computer; }
+	inline const std::vector<Value>& GetCollectedOutputs(NodeId node) const { return m_Nodes[node]->m_CollectedOutputs; }
+
+private:
+	enum class NodeState : std::uint8_t
+	{
+		Parked,
+		Scheduled,
+		Running,
+		Rescheduled,
+		Stopped
+	};
+
+	struct Node
+	{
+		explicit Node(IntCodeProgramImagePtr image) : m_Computer(std::move(image)) {}
+
+		Computer							m_Computer;
+
+		// Only used by computers which don't share their channels with a single peer
+		std::vector<IntCodeChannelPtr<Value>>	m_IncomingChannels;
+		std::vector<IntCodeChannelPtr<Value>>	m_OutgoingChannels;
+		bool								m_GathersInputs = false;
+		bool								m_ForwardsOutputs = false;
+
+		bool								m_CollectsOutputs = false;
+		std::vector<Value>					m_CollectedOutputs;
+
+		std::vector<NodeId>					m_Senders;
+		std::vector<NodeId>					m_Receivers;
+
+		std::atomic<NodeState>				m_State { NodeState::Parked };
+	};
+
+	void Wake(NodeId node);
+	void RunNode(NodeId node);
+
+	// Returns true if the computer should run again right away
+	bool Step(Node& node);
+	std::size_t GatherInputs(Node& node);
+	std::size_t ForwardOutputs(Node& node);
+
+	std::vector<std::unique_ptr<Node>>	m_Nodes;
+	WorkStealingThreadPool*				m_Pool = nullptr;
+};
+
+extern template class BasicIntCodeNetwork<IntCodeInt64Policy>;
+extern template class BasicIntCodeNetwork<IntCodeBigIntPolicy>;
+
+using IntCodeNetwork = BasicIntCodeNetwork<IntCodeInt64Policy>;
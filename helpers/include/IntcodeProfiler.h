@@ -0,0 +1,151 @@
+#pragma once
+
+#include <IntcodeDefinitions.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************************************************
+
+ A ProfilingPolicy tells an IntCode computer what to record while it runs.
+
+ The computer calls the policy's hooks from its main loop, only when IsEnabled is true:
+ with IntCodeNoProfiling (the default) the hooks aren't even compiled in.
+
+************************************************************************************************/
+
+struct IntCodeNoProfiling
+{
+	static constexpr bool IsEnabled = false;
+};
+
+/***********************************************************************************************
+
+ Counts what an IntCode program does: instructions executed per opcode and per address,
+ how often each JT / JF jumped or fell through, and how often the computer had to stop
+ on an IN with no input or an OUT with a full output channel.
+
+ Profiles of several runs (or several computers) can be merged, and exported as JSON or
+ as folded stacks (opcode;address count), which flamegraph tools take as is.
+
+************************************************************************************************/
+
+class IntCodeProfiler : public IntCodeDefinitions
+{
+public:
+	static constexpr bool IsEnabled = true;
+
+	struct AddressProfile
+	{
+		OpCode			m_OpCode = OpCode::HLT;
+		std::uint64_t	m_Hits = 0;
+		std::uint64_t	m_TakenBranches = 0;
+		std::uint64_t	m_UntakenBranches = 0;
+		std::uint64_t	m_Waits = 0;
+	};
+
+	// Hooks, see BasicIntCodeComputer::Execute
+	inline void OnInstruction(IntCodeAddress address, OpCode opCode)
+	{
+		m_OpCodeCounts[GetOpCodeIndex(opCode)]++;
+
+		AddressProfile& profile = GetAddressProfile(address);
+		profile.m_OpCode = opCode;
+		profile.m_Hits++;
+	}
+
+	inline void OnBranch(IntCodeAddress address, bool isTaken)
+	{
+		AddressProfile& profile = GetAddressProfile(address);
+		(isTaken ? profile.m_TakenBranches : profile.m_UntakenBranches)++;
+	}
+
+	inline void OnInputWait(IntCodeAddress address)
+	{
+		m_InputWaits++;
+		GetAddressProfile(address).m_Waits++;
+	}
+
+	inline void OnOutputWait(IntCodeAddress address)
+	{
+		m_OutputWaits++;
+		GetAddressProfile(address).m_Waits++;
+	}
+
+	void Merge(const IntCodeProfiler& other);
+	void Clear();
+
+	std::uint64_t GetInstructionCount() const;
+	inline std::uint64_t GetOpCodeCount(OpCode opCode) const { return m_OpCodeCounts[GetOpCodeIndex(opCode)]; }
+	inline std::uint64_t GetInputWaits() const { return m_InputWaits; }
+	inline std::uint64_t GetOutputWaits() const { return m_OutputWaits; }
+
+	// Everything zero for addresses never executed
+	AddressProfile GetAddressProfile(IntCodeAddress address) const;
+
+	// Calls visitor(address, profile) for every address executed at least once, in order
+	template<typename Visitor>
+	void ForEachAddress(Visitor visitor) const;
+
+	void WriteJson(std::ostream& output) const;
+	void WriteFoldedStacks(std::ostream& output) const;
+
+private:
+	// Program addresses are small and dense, others go to a map
+	static constexpr IntCodeAddress MaxDenseAddress = IntCodeAddress(1) << 20;
+
+	static constexpr std::size_t OpCodeCount = 10;
+	static constexpr std::size_t GetOpCodeIndex(OpCode opCode) { return opCode == OpCode::HLT ? 0 : static_cast<std::size_t>(opCode); }
+
+	inline AddressProfile& GetAddressProfile(IntCodeAddress address)
+	{
+		if (address >= MaxDenseAddress)
+		{
+			return m_FarAddresses[address];
+		}
+
+		if (address >= m_Addresses.size())
+		{
+			m_Addresses.resize(std::max<std::size_t>(address + 1, m_Addresses.size() * 2));
+		}
+
+		return m_Addresses[address];
+	}
+
+	std::array<std::uint64_t, OpCodeCount>				m_OpCodeCounts = {};
+	std::uint64_t										m_InputWaits = 0;
+	std::uint64_t										m_OutputWaits = 0;
+
+	std::vector<AddressProfile>							m_Addresses;
+	std::unordered_map<IntCodeAddress, AddressProfile>	m_FarAddresses;
+};
+
+template<typename Visitor>
+void IntCodeProfiler::ForEachAddress(Visitor visitor) const
+{
+	for (IntCodeAddress address = 0; address < m_Addresses.size(); address++)
+	{
+		const AddressProfile& profile = m_Addresses[address];
+		if (profile.m_Hits > 0 || profile.m_Waits > 0)
+		{
+			visitor(address, profile);
+		}
+	}
+
+	std::vector<IntCodeAddress> farAddresses;
+	farAddresses.reserve(m_FarAddresses.size());
+	for (const auto& [address, profile] : m_FarAddresses)
+	{
+		farAddresses.push_back(address);
+	}
+
+	std::sort(farAddresses.begin(), farAddresses.end());
+	for (IntCodeAddress address : farAddresses)
+	{
+		visitor(address, m_FarAddresses.at(address));
+	}
+}
@@ -1,176 +1,552 @@
 #pragma once
 
+#include <IntcodeChannel.h>
+#include <IntcodeCoroutine.h>
+#include <IntcodeDefinitions.h>
+#include <IntcodeProfiler.h>
+#include <IntcodeProgramImage.h>
+#include <IntcodeSnapshot.h>
+#include <IntcodeTrace.h>
+#include <IntcodeValuePolicies.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <limits>
 #include <memory>
-#include <sstream>
+#include <span>
 #include <string>
 #include <unordered_map>
+#include <variant>
 #include <vector>
 
-#include <boost/multiprecision/cpp_int.hpp>
+class IntCodeJit;
 
-using IntCodeAddress = boost::multiprecision::cpp_int;
-using IntCodeValue = boost::multiprecision::cpp_int;
-using IntCodeProgram = std::vector<IntCodeValue>;
+/***********************************************************************************************
 
+ The memory of an IntCode computer.
+
+ A two-level page table: the directory points to page tables, which point to fixed-size
+ pages of values. Pages are only allocated when first written, anything never written
+ reads as 0. Addresses too far for the directory fall back to a map of pages.
+
+ Both tables and pages are shared copy-on-write: copying an IntCodeMemory only copies
+ the directory, and a table or page is duplicated the first time it gets written while
+ someone else still references it.
+
+************************************************************************************************/
+
+template<typename ValuePolicy>
 class IntCodeMemory
 {
 public:
-	inline bool IsLoaded() const { return !(m_SequentialMemory.empty() && m_UnboundedMemory.empty()); }
+	using Value = typename ValuePolicy::Value;
+
+	static constexpr std::size_t PageBits = 8;
+	static constexpr std::size_t PageSize = std::size_t(1) << PageBits;
+	static constexpr std::size_t PageMask = PageSize - 1;
+
+	static constexpr std::size_t TableBits = 8;
+	static constexpr std::size_t TableSize = std::size_t(1) << TableBits;
+	static constexpr std::size_t TableMask = TableSize - 1;
+
+	// Addresses up to 2^32 go through the directory
+	static constexpr std::size_t MaxDirectorySize = std::size_t(1) << (32 - PageBits - TableBits);
+
+	using Page = std::array<Value, PageSize>;
+	using PageTable = std::array<std::shared_ptr<Page>, TableSize>;
+
+	inline bool IsLoaded() const { return !(m_Directory.empty() && m_FarPages.empty()); }
+
+	// Implementation choice: ReadValue returns a reference to a shared 0 for addresses never
+	// written to, rather than putting a 0 there on read. The reference only holds until the
+	// next write to memory.
+
+	void Reset(const std::vector<Value>& initialProgram);
+	void StoreValue(IntCodeAddress address, Value value);
+	const Value& ReadValue(IntCodeAddress address) const;
+
+	// Stores the value, and gives back the one it replaces: with unbounded values, the
+	// caller can compute its next result in that value's limbs instead of allocating
+	void SwapValue(IntCodeAddress address, Value& value);
+
+	// Calls visitor(firstAddress, page) for every allocated page, in no particular order
+	template<typename PageVisitor>
+	void ForEachPage(PageVisitor visitor) const;
+
+	// Pages not shared with base (the memory as the program was loaded), see IntCodeSnapshot.
+	// Reading them writes over the current content.
+	void WriteSnapshot(std::ostream& output, const IntCodeMemory& base) const;
+	bool ReadSnapshot(std::istream& input);
 
-	// Implementation choice: ReadValue returns by value (no pun intended)
-	// This is because reading from an arbitrary unbounded address has to return 0
-	// if such address has never been written to. 
-	//
-	// The alternative would have been to have a non-const read which puts the 0 on
-	// read, which although maybe more efficent would have been hacky at best.
+	// Used when promoting a computer to a wider ValuePolicy
+	template<typename SourcePolicy>
+	bool TryConvertFrom(const IntCodeMemory<SourcePolicy>& other);
 
-	void Reset(IntCodeProgram initialProgram);
-	void StoreValue(const IntCodeAddress& address, IntCodeValue value);
-	IntCodeValue ReadValue(const IntCodeAddress& address) const;
+	// Flat views of the pages the directory covers, for compiled code (see IntCodeJit).
+	// Missing pages read from zeroPage. Only pages nobody else shares can be written in place,
+	// the others are null in writablePages.
+	void ExportPages(const Page& zeroPage, std::vector<const Value*>& readablePages, std::vector<Value*>& writablePages);
 
 private:
-	bool IsAddressInSequentialMemoryRange(const IntCodeAddress& address) const;
+	template<typename OtherPolicy>
+	friend class IntCodeMemory;
 
-	std::vector<IntCodeValue> m_SequentialMemory;
-	std::unordered_map<IntCodeAddress, IntCodeValue> m_UnboundedMemory;
+	const Page* FindPage(std::size_t pageIndex) const;
+	Page& GetWritablePage(std::size_t pageIndex);
+
+	template<typename T>
+	static void MakeWritable(std::shared_ptr<T>& pointer);
+
+	static inline const Value ZeroValue = 0;
+
+	std::vector<std::shared_ptr<PageTable>>						m_Directory;
+	std::unordered_map<std::size_t, std::shared_ptr<Page>>		m_FarPages;
 };
 
-class IntCodeComputer
+template<typename ValuePolicy>
+template<typename PageVisitor>
+void IntCodeMemory<ValuePolicy>::ForEachPage(PageVisitor visitor) const
 {
-public:
-	enum class ExecutionProgress
+	for (std::size_t tableIndex = 0; tableIndex < m_Directory.size(); tableIndex++)
 	{
-		Continue,
-		Jump,
-		Pause,
-		Halt
-	};
+		if (!m_Directory[tableIndex])
+		{
+			continue;
+		}
+
+		const PageTable& table = *m_Directory[tableIndex];
+		for (std::size_t pageOffset = 0; pageOffset < TableSize; pageOffset++)
+		{
+			if (table[pageOffset])
+			{
+				visitor(((tableIndex << TableBits) + pageOffset) << PageBits, *table[pageOffset]);
+			}
+		}
+	}
 
-	enum class ExecutionStatus
+	for (const auto& [pageIndex, page] : m_FarPages)
 	{
-		NotStarted,
-		Running,
-		Paused,
-		Halted
-	};
+		visitor(pageIndex << PageBits, *page);
+	}
+}
 
-	struct InitData
-	{
-		IntCodeValue noun;
-		IntCodeValue verb;
-	};
+extern template class IntCodeMemory<IntCodeInt64Policy>;
+extern template class IntCodeMemory<IntCodeBigIntPolicy>;
+#if INTCODE_HAS_INT128
+extern template class IntCodeMemory<IntCodeInt128Policy>;
+#endif
 
-	enum class OpCode : int
-	{
-		ADD = 1,
-		MUL = 2,
-		IN_ = 3,
-		OU_ = 4,
-		JT_ = 5,
-		JF_ = 6,
-		LT_ = 7,
-		EQU = 8,
-		RBS = 9,
-		HLT = 99
-	};
+/***********************************************************************************************
 
-	enum class ParameterMode : int
-	{
-		POS = 0,
-		IMM = 1,
-		REL = 2
-	};
+ An IntCode computer working on a single ValuePolicy.
+
+ With a fixed width policy, an ADD or MUL (or an input) that doesn't fit stops the
+ computer right before the offending instruction with ExecutionStatus::Overflowed,
+ leaving memory untouched. The computer can then be moved into a wider one, which
+ will resume from that very instruction.
+
+ The ProfilingPolicy decides what gets recorded along the way, see IntcodeProfiler.h.
+ Profiled computers never compile anything, every instruction goes through the
+ interpreter and gets counted.
+
+************************************************************************************************/
+
+template<typename ValuePolicy, typename ProfilingPolicy = IntCodeNoProfiling>
+class BasicIntCodeComputer : public IntCodeDefinitions
+{
+public:
+	using Value = typename ValuePolicy::Value;
+	using Program = std::vector<Value>;
 
-	explicit IntCodeComputer(std::string filename);
+	// The computer is left invalid if the program doesn't fit in the ValuePolicy
+	explicit BasicIntCodeComputer(IntCodeProgramImagePtr image);
+	explicit BasicIntCodeComputer(const std::string& filename);
+	explicit BasicIntCodeComputer(IntCodeProgram program);
 
-	IntCodeComputer(const IntCodeComputer& other) = delete;
-	IntCodeComputer& operator=(const IntCodeComputer& other) = delete;
+	// Takes over the whole execution state of a computer with a different policy.
+	// Pending input and output are carried over into new channels.
+	template<typename SourcePolicy>
+	explicit BasicIntCodeComputer(BasicIntCodeComputer<SourcePolicy, ProfilingPolicy>&& other);
 
-	// The internal streams are trivially movable, but not copyable
-	IntCodeComputer(IntCodeComputer&& other) = default;
-	IntCodeComputer& operator=(IntCodeComputer&& other) = default;
+	BasicIntCodeComputer(const BasicIntCodeComputer& other) = delete;
+	BasicIntCodeComputer& operator=(const BasicIntCodeComputer& other) = delete;
+
+	BasicIntCodeComputer(BasicIntCodeComputer&& other) = default;
+	BasicIntCodeComputer& operator=(BasicIntCodeComputer&& other) = default;
+
+	// No limit on how many instructions Execute runs
+	static constexpr std::uint64_t UnlimitedInstructions = std::numeric_limits<std::uint64_t>::max();
+
+	// Instructions ExecuteUntil runs between two looks at the clock
+	static constexpr std::uint64_t DeadlineSliceInstructions = std::uint64_t(1) << 16;
 
 	void SetNounAndVerb(InitData init);
 	void Reset();
-	void Execute();
 
-	template<typename T>
-	inline bool FeedInput(T input) { return bool(m_InputStream << input << std::endl); }
-
-	template<typename T>
-	inline bool GetOutput(T& output) { return bool(m_OutputStream >> output); }
+	// Runs until the program halts, waits, or maxInstructions ran: the computer is then
+	// ExecutionStatus::Preempted, and the next Execute picks up right where it stopped.
+	// A superinstruction straddling the limit runs whole, so one more instruction can run.
+	// Compiled code (see SetJitEnabled) only ever runs without a limit.
+	void Execute(std::uint64_t maxInstructions = UnlimitedInstructions);
+
+	// Same, in slices of DeadlineSliceInstructions until the deadline passed. At least one
+	// slice runs, so the deadline can be overshot by that much.
+	void ExecuteUntil(std::chrono::steady_clock::time_point deadline);
+
+	// Runs until the program first touches any of the cells (runs, reads or writes it), and
+	// pauses right before that instruction. Up to there, the run doesn't depend on what the
+	// cells hold: a sweep over their values can Fork the computer there, set the cells and
+	// Execute, instead of running that shared prefix every time. Also stops wherever Execute
+	// would, e.g. on the first IN without input, which is where sweeps over inputs fork.
+	void ExecuteUntilAccess(std::span<const IntCodeAddress> cells);
+
+	// A new computer in the exact same state, pending input and output included.
+	// Memory pages are shared until either computer writes them, channels are not.
+	BasicIntCodeComputer Fork();
+
+	// The whole execution state, pending input and output included, see IntCodeSnapshot.
+	// Settings (pause on output, JIT) aren't part of it, nor is the profiler.
+	void SaveSnapshot(std::ostream& output) const;
+
+	// Restores a snapshot saved by a computer running the same program with the same
+	// ValuePolicy. On failure, the computer is left reset.
+	bool LoadSnapshot(std::istream& input);
+
+	// Same, once the header has already been read
+	bool LoadSnapshot(std::istream& input, const IntCodeSnapshot::Header& header);
+
+	// Runs the computer as a coroutine, see IntCodeCoroutine
+	IntCodeCoroutine<Value> Run();
+
+	// Resumes from the given instruction on the next Execute, as if the computer had paused
+	// right there. Lets a computer take over a program some other engine started running.
+	void SetExecutionState(IntCodeAddress instructionPointer, Value relativeBase);
+
+	// Both return how many values were actually fed / drained. The computer stops on an
+	// IN with no input available (ExecutionStatus::AwaitingInput), or pauses on an OUT with
+	// the output channel full, and resumes from that very instruction.
+	inline std::size_t FeedInputs(std::span<const Value> inputs) { return m_InputChannel->Push(inputs); }
+	inline std::size_t DrainOutputs(std::span<Value> outputs) { return m_OutputChannel->Pop(outputs); }
+	inline std::size_t GetOutputCount() const { return m_OutputChannel->GetSize(); }
+
+	// Channels can be shared, e.g. the output of a computer can be the input of another one,
+	// as long as each channel has one computer (or thread) writing and one reading.
+	inline const IntCodeChannelPtr<Value>& GetInputChannel() const { return m_InputChannel; }
+	inline const IntCodeChannelPtr<Value>& GetOutputChannel() const { return m_OutputChannel; }
+	inline void SetInputChannel(IntCodeChannelPtr<Value> channel) { m_InputChannel = std::move(channel); }
+	inline void SetOutputChannel(IntCodeChannelPtr<Value> channel) { m_OutputChannel = std::move(channel); }
 
 	inline void SetPauseOnOutput(bool pauseOnOutput) { m_PauseOnOutput = pauseOnOutput; }
+
+	// Compiles hot loops into native code as they run, see IntCodeJit.
+	// Only 64 bit computers on supported platforms have one, elsewhere this does nothing.
+	void SetJitEnabled(bool isEnabled);
+	inline bool IsJitEnabled() const { return m_Jit != nullptr; }
+	inline const IntCodeJit* GetJit() const { return m_Jit.get(); }
+
 	inline bool IsValid() const { return m_Memory.IsLoaded(); }
 	inline bool IsRunning() const { return m_Status == ExecutionStatus::Running; }
 	inline bool IsHalted() const { return m_Status == ExecutionStatus::Halted; }
-	inline IntCodeValue GetValueAt(IntCodeAddress address) const { return m_Memory.ReadValue(address); }
+	inline bool IsPaused() const { return m_Status == ExecutionStatus::Paused; }
+	inline bool IsPreempted() const { return m_Status == ExecutionStatus::Preempted; }
+	inline bool IsAwaitingInput() const { return m_Status == ExecutionStatus::AwaitingInput; }
+	inline bool IsOverflowed() const { return m_Status == ExecutionStatus::Overflowed; }
+	inline IntCodeValue GetValueAt(IntCodeAddress address) const { return ValuePolicy::ToBigInt(m_Memory.ReadValue(address)); }
+
+	// Instructions run since the computer started or got reset (a superinstruction counts for
+	// two), carried over by Fork and promotions. Compiled code doesn't count the ones it runs.
+	inline std::uint64_t GetInstructionCount() const { return m_InstructionCount; }
+	inline void SetValueAt(IntCodeAddress address, Value value) { StoreValue(address, std::move(value)); }
+
+	inline const IntCodeProgramImagePtr& GetImage() const { return m_Image; }
+
+	// Kept by Reset and carried over by a move into a wider policy, but not by Fork
+	inline ProfilingPolicy& GetProfiler() { return m_Profiler; }
+	inline const ProfilingPolicy& GetProfiler() const { return m_Profiler; }
 
 private:
-	using InstructionFnc = ExecutionProgress(IntCodeComputer::*)();
-	using InstructionSet = std::unordered_map<OpCode, InstructionFnc>;
+	template<typename OtherPolicy, typename OtherProfilingPolicy>
+	friend class BasicIntCodeComputer;
 
-	// Used for static init of the InstructionSet
-	class InstructionSetHolder
+	struct ForkTag {};
+	BasicIntCodeComputer(BasicIntCodeComputer& parent, ForkTag);
+
+	template<typename SourceValue, typename Conversion>
+	static IntCodeChannelPtr<Value> CopyChannel(const IntCodeChannel<SourceValue>& source, Conversion conversion);
+
+	// An instruction with its opcode and parameter modes already extracted
+	struct Operation
 	{
-	public:
-		InstructionSetHolder();
-		inline const InstructionSet& GetInstructionSet() const { return m_InstructionSet; }
+		OpCode							m_OpCode = OpCode::HLT;
+		std::array<ParameterMode, 3>	m_ParameterModes = { ParameterMode::POS, ParameterMode::POS, ParameterMode::POS };
+		std::array<Value, 3>			m_Parameters = { 0, 0, 0 };
+	};
 
-	private:
-		InstructionSet m_InstructionSet;
+	// Common pairs of instructions, run within a single dispatch (see FuseInstructions)
+	enum class Superinstruction : std::uint8_t
+	{
+		None,
+
+		// LT or EQ, then a JT or JF testing the cell it just wrote
+		CompareAndBranch,
+
+		// ADD, MUL, LT, EQ or RBS (counters, base moves before relative accesses...),
+		// then any instruction but I/O or HLT
+		Sequence
+	};
+
+	// The instruction found in memory at some address. Decoding happens once per address,
+	// and is thrown away whenever the program writes over any of the instruction's words.
+	// A superinstruction holds the next instruction too, and its length covers both.
+	struct DecodedInstruction : Operation
+	{
+		enum class State : std::uint8_t
+		{
+			Stale,
+			Valid,
+			Invalid
+		};
+
+		State							m_State = State::Stale;
+		std::uint8_t					m_Length = 1;
+
+		Superinstruction				m_Superinstruction = Superinstruction::None;
+		std::uint8_t					m_FirstLength = 1;
+		Operation						m_Next;
 	};
 
-	static IntCodeProgram LoadFromFile(const std::string& filename);
+	// Longest superinstruction
+	static constexpr std::size_t MaxFusedLength = 2 * MaxInstructionLength;
 
-	ExecutionProgress ProcessCurrentInstruction();
-	IntCodeValue GetValueFromParameterMode(ParameterMode mode, IntCodeValue value) const;
-	IntCodeAddress GetAddressFromParameterMode(ParameterMode mode, IntCodeValue value) const;
+	const DecodedInstruction& FetchCurrentInstruction();
+	void DecodeInstruction(IntCodeAddress address, DecodedInstruction& instruction) const;
+	void InvalidateDecodedInstructions(IntCodeAddress writtenAddress);
 
-	static bool IsValueAnInstructionCode(IntCodeValue value);
-	static bool IsValueAParameterMode(IntCodeValue value);
+	// Turns a freshly decoded instruction into a superinstruction, if it starts a pair worth fusing
+	void FuseInstructions(IntCodeAddress address, DecodedInstruction& instruction) const;
 
-	static std::vector<ParameterMode> ExtractParameterModes(IntCodeValue value, std::size_t count);
+	bool GetParameterValue(const Operation& instruction, std::size_t index, Value& value) const;
+	bool GetParameterAddress(const Operation& instruction, std::size_t index, IntCodeAddress& address) const;
+	void StoreValue(IntCodeAddress address, Value value);
+	void SwapValue(IntCodeAddress address, Value& value);
+	void OnStore(IntCodeAddress address);
 
-	ExecutionProgress Add();
-	ExecutionProgress Mul();
-	ExecutionProgress Input();
-	ExecutionProgress Output();
-	ExecutionProgress JumpIfTrue();
-	ExecutionProgress JumpIfFalse();
-	ExecutionProgress LessThan();
-	ExecutionProgress Equals();
-	ExecutionProgress Rebase();
-	ExecutionProgress Halt() { return ExecutionProgress::Halt; }
+	// Where instructions read their operands and compute their result. With unbounded values
+	// that's m_Operands, so that limbs get reused from one instruction to the next (results
+	// are swapped into memory), with fixed width ones a fresh array which stays in registers.
+	inline decltype(auto) GetOperands()
+	{
+		if constexpr (ValuePolicy::IsUnbounded)
+		{
+			return (m_Operands);
+		}
+		else
+		{
+			return std::array<Value, 3>();
+		}
+	}
+
+	// Right after a jump: runs compiled code from the new instruction, if there's any
+	void TryRunCompiledCode(IntCodeAddress jumpSource);
+
+	// Whether the instruction at this address touches any of m_WatchedCells
+	bool IsAccessingWatchedCells(IntCodeAddress address, const DecodedInstruction& instruction) const;
+
+	// Reports an instruction that just ran (or couldn't) to the ProfilingPolicy
+	void Profile(IntCodeAddress address, OpCode opCode, ExecutionProgress status);
+
+	ExecutionProgress Add(const Operation& instruction);
+	ExecutionProgress Mul(const Operation& instruction);
+	ExecutionProgress Input(const Operation& instruction);
+	ExecutionProgress Output(const Operation& instruction);
+	ExecutionProgress JumpIfTrue(const Operation& instruction);
+	ExecutionProgress JumpIfFalse(const Operation& instruction);
+	ExecutionProgress LessThan(const Operation& instruction);
+	ExecutionProgress Equals(const Operation& instruction);
+	ExecutionProgress Rebase(const Operation& instruction);
+	ExecutionProgress InvalidInstruction(const DecodedInstruction& instruction);
+
+	// Runs the operation, which must not be an I/O or HLT
+	ExecutionProgress Dispatch(const Operation& instruction);
+	ExecutionProgress ExecuteSuperinstruction(const DecodedInstruction& instruction);
+
+	template<typename IntCodeOperation>
+	ExecutionProgress InternalArithmetic(const Operation& instruction, IntCodeOperation operation);
 
 	template<typename IntCodeTest>
-	ExecutionProgress InternalJump(IntCodeTest test);
+	ExecutionProgress InternalJump(const Operation& instruction, IntCodeTest test);
 
 	template<typename IntCodeComparison>
-	ExecutionProgress InternalCompare(IntCodeComparison compare);
+	ExecutionProgress InternalCompare(const Operation& instruction, IntCodeComparison compare);
+
+	ExecutionProgress InvalidAddress();
+
+	IntCodeProgramImagePtr			m_Image;
+
+	// Reset copies this one, which only shares the pages
+	IntCodeMemory<ValuePolicy>		m_InitialMemory;
+	IntCodeMemory<ValuePolicy>		m_Memory;
+
+	// One entry per address of the original program, and a few past its end so that its
+	// last instructions get cached too. Instructions further away are decoded on the fly
+	// in m_ScratchInstruction.
+	std::vector<DecodedInstruction>	m_DecodedInstructions;
+	DecodedInstruction				m_ScratchInstruction;
+
+	// See GetOperands
+	std::array<Value, 3>			m_Operands;
+
+	IntCodeAddress					m_InstructionPointer = 0;
+	Value							m_RelativeBase = 0;
+	ExecutionStatus					m_Status = ExecutionStatus::NotStarted;
+	bool							m_PauseOnOutput = false;
+	std::uint64_t					m_InstructionCount = 0;
+
+	// See ExecuteUntilAccess. Nothing gets fused nor compiled while cells are watched.
+	std::vector<IntCodeAddress>		m_WatchedCells;
+
+	// Copied by Fork, compiled code itself is shared
+	std::shared_ptr<IntCodeJit>		m_Jit;
+
+	[[no_unique_address]] ProfilingPolicy	m_Profiler;
+
+	IntCodeChannelPtr<Value>		m_OutputChannel;
+	IntCodeChannelPtr<Value>		m_InputChannel;
+};
+
+extern template class BasicIntCodeComputer<IntCodeInt64Policy>;
+extern template class BasicIntCodeComputer<IntCodeBigIntPolicy>;
+extern template class BasicIntCodeComputer<IntCodeInt64Policy, IntCodeProfiler>;
+extern template class BasicIntCodeComputer<IntCodeBigIntPolicy, IntCodeProfiler>;
+#if INTCODE_HAS_INT128
+extern template class BasicIntCodeComputer<IntCodeInt128Policy>;
+#endif
+
+/***********************************************************************************************
+
+ The default IntCode computer.
+
+ Runs on 64 bit integers, and promotes itself to arbitrary precision the first time
+ an instruction overflows (or right away, if the program itself doesn't fit).
+ Results are always exact, but most programs never pay for bignum arithmetic.
+
+ IntCodeComputer records nothing, ProfiledIntCodeComputer counts everything it runs.
+
+************************************************************************************************/
+
+template<typename ProfilingPolicy>
+class PromotingIntCodeComputer : public IntCodeDefinitions
+{
+public:
+	using FastComputer = BasicIntCodeComputer<IntCodeInt64Policy, ProfilingPolicy>;
+	using BigComputer = BasicIntCodeComputer<IntCodeBigIntPolicy, ProfilingPolicy>;
 
-	static const InstructionSet& GetInstructionSet() 
+	explicit PromotingIntCodeComputer(IntCodeProgramImagePtr image);
+	explicit PromotingIntCodeComputer(const std::string& filename);
+	explicit PromotingIntCodeComputer(IntCodeProgram program);
+
+	PromotingIntCodeComputer(const PromotingIntCodeComputer& other) = delete;
+	PromotingIntCodeComputer& operator=(const PromotingIntCodeComputer& other) = delete;
+
+	PromotingIntCodeComputer(PromotingIntCodeComputer&& other) = default;
+	PromotingIntCodeComputer& operator=(PromotingIntCodeComputer&& other) = default;
+
+	static constexpr std::uint64_t UnlimitedInstructions = FastComputer::UnlimitedInstructions;
+
+	void SetNounAndVerb(InitData init);
+	void Reset();
+
+	// See BasicIntCodeComputer::Execute. The limit covers instructions run before and after a promotion.
+	void Execute(std::uint64_t maxInstructions = UnlimitedInstructions);
+
+	// See BasicIntCodeComputer::ExecuteUntil
+	void ExecuteUntil(std::chrono::steady_clock::time_point deadline);
+
+	// See BasicIntCodeComputer::ExecuteUntilAccess
+	void ExecuteUntilAccess(std::span<const IntCodeAddress> cells);
+
+	// See BasicIntCodeComputer::Fork
+	PromotingIntCodeComputer Fork();
+
+	// See BasicIntCodeComputer::SaveSnapshot. Snapshots of a promoted computer promote the
+	// computer they are loaded into, the others bring it back to 64 bits.
+	void SaveSnapshot(std::ostream& output) const;
+	bool LoadSnapshot(std::istream& input);
+
+	// See BasicIntCodeComputer::Run
+	IntCodeCoroutine<IntCodeValue> Run();
+
+	// See BasicIntCodeComputer::SetExecutionState
+	void SetExecutionState(IntCodeAddress instructionPointer, const IntCodeValue& relativeBase);
+
+	// Feeding a value that doesn't fit 64 bits promotes the computer.
+	// Draining into 64 bit values stops right before the first output that doesn't fit.
+	std::size_t FeedInputs(std::span<const std::int64_t> inputs);
+	std::size_t FeedInputs(std::span<const IntCodeValue> inputs);
+	std::size_t DrainOutputs(std::span<std::int64_t> outputs);
+	std::size_t DrainOutputs(std::span<IntCodeValue> outputs);
+	inline std::size_t GetOutputCount() const { return std::visit([](const auto& computer) { return computer.GetOutputCount(); }, m_Computer); }
+
+	void SetPauseOnOutput(bool pauseOnOutput);
+
+	// Only ever applies to the 64 bit computer, see BasicIntCodeComputer::SetJitEnabled
+	void SetJitEnabled(bool isEnabled);
+
+	inline bool IsValid() const { return std::visit([](const auto& computer) { return computer.IsValid(); }, m_Computer); }
+	inline bool IsRunning() const { return std::visit([](const auto& computer) { return computer.IsRunning(); }, m_Computer); }
+	inline bool IsHalted() const { return std::visit([](const auto& computer) { return computer.IsHalted(); }, m_Computer); }
+	inline bool IsPaused() const { return std::visit([](const auto& computer) { return computer.IsPaused(); }, m_Computer); }
+	inline bool IsPreempted() const { return std::visit([](const auto& computer) { return computer.IsPreempted(); }, m_Computer); }
+	inline bool IsAwaitingInput() const { return std::visit([](const auto& computer) { return computer.IsAwaitingInput(); }, m_Computer); }
+	inline bool IsPromoted() const { return std::holds_alternative<BigComputer>(m_Computer); }
+	inline std::uint64_t GetInstructionCount() const { return std::visit([](const auto& computer) { return computer.GetInstructionCount(); }, m_Computer); }
+	inline const IntCodeProgramImagePtr& GetImage() const { return std::visit([](const auto& computer) -> const IntCodeProgramImagePtr& { return computer.GetImage(); }, m_Computer); }
+	IntCodeValue GetValueAt(IntCodeAddress address) const;
+
+	// Promotes the computer if the value doesn't fit 64 bits
+	void SetValueAt(IntCodeAddress address, const IntCodeValue& value);
+
+	// Records everything the computer is given and gives back from now on, null stops recording.
+	// Replays start from a reset computer: a trace set after the computer started won't match.
+	// Forks record into a copy of the trace, and loading a snapshot ends the recording.
+	// Compiled code doesn't count instructions: the JIT stays off while recording.
+	// See IntCodeTraceRecorder to record every computer.
+	void SetTrace(IntCodeTracePtr trace);
+	inline const IntCodeTracePtr& GetTrace() const { return m_Trace; }
+
+	// Follows the program through promotions and resets, see BasicIntCodeComputer::GetProfiler
+	inline ProfilingPolicy& GetProfiler() { return std::visit([](auto& computer) -> ProfilingPolicy& { return computer.GetProfiler(); }, m_Computer); }
+	inline const ProfilingPolicy& GetProfiler() const { return std::visit([](const auto& computer) -> const ProfilingPolicy& { return computer.GetProfiler(); }, m_Computer); }
+
+private:
+	using ComputerVariant = std::variant<FastComputer, BigComputer>;
+
+	PromotingIntCodeComputer(ComputerVariant computer, bool pauseOnOutput);
+
+	static ComputerVariant MakeComputer(IntCodeProgramImagePtr image);
+
+	void Promote();
+
+	inline void RecordEvent(IntCodeTrace::EventKind kind, std::uint64_t argument = 0, const IntCodeValue& value = 0) const
 	{
-		static const InstructionSetHolder ms_InstructionSetHolder;
-		return ms_InstructionSetHolder.GetInstructionSet(); 
+		if (m_Trace)
+		{
+			m_Trace->Record(kind, argument, value, GetInstructionCount());
+		}
 	}
 
-	inline std::ostream& GetOutputStream() { return m_OutputStream; }
-	inline std::istream& GetInputStream() { return m_InputStream; }
+	ComputerVariant m_Computer;
+	IntCodeTracePtr m_Trace;
+	bool m_PauseOnOutput = false;
+	bool m_IsJitEnabled = false;
+};
 
-	inline const IntCodeValue GetCurrentInstruction() const { return m_Memory.ReadValue(m_InstructionPointer); }
-	inline const IntCodeValue GetNextValueAndStepPointer() { return m_Memory.ReadValue(++m_InstructionPointer); }
-	inline OpCode GetCurrentOpCode() const { return static_cast<OpCode>((GetCurrentInstruction() % 100).convert_to<int>()); }
+extern template class PromotingIntCodeComputer<IntCodeNoProfiling>;
+extern template class PromotingIntCodeComputer<IntCodeProfiler>;
 
-	const IntCodeProgram m_OriginalProgram;
-	
-	IntCodeMemory		m_Memory;
-	IntCodeAddress		m_InstructionPointer = 0;
-	IntCodeAddress		m_RelativeBase = 0;
-	ExecutionStatus		m_Status = ExecutionStatus::NotStarted;
-	bool				m_PauseOnOutput = false;
+using IntCodeComputer = PromotingIntCodeComputer<IntCodeNoProfiling>;
 
-	std::stringstream	m_OutputStream;
-	std::stringstream	m_InputStream;
-};
\ No newline at end of file
+// Counts everything it executes, see IntCodeProfiler
+using ProfiledIntCodeComputer = PromotingIntCodeComputer<IntCodeProfiler>;
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <IntcodeValuePolicies.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+class IntCodeProgramImage;
+using IntCodeProgramImagePtr = std::shared_ptr<const IntCodeProgramImage>;
+
+/***********************************************************************************************
+
+ An immutable, shareable IntCode program.
+
+ Besides the program itself, an image keeps the conversions computers need to run it
+ (so that building a computer out of an image is just a pointer copy), and a hash of
+ its content, stable across runs and platforms.
+
+************************************************************************************************/
+
+class IntCodeProgramImage
+{
+public:
+	static IntCodeProgramImagePtr Create(IntCodeProgram program);
+
+	static IntCodeProgram Parse(const std::string& programText);
+	static std::uint64_t ComputeHash(const IntCodeProgram& program);
+
+	inline const IntCodeProgram& GetProgram() const { return *m_Program; }
+	inline std::uint64_t GetHash() const { return m_Hash; }
+	inline std::size_t GetSize() const { return m_Program->size(); }
+	inline bool IsEmpty() const { return m_Program->empty(); }
+
+	// The program converted for the given ValuePolicy, null if it doesn't fit.
+	// The returned pointer shares ownership with the image.
+	template<typename ValuePolicy>
+	std::shared_ptr<const std::vector<typename ValuePolicy::Value>> GetProgramFor() const;
+
+private:
+	// Use Create
+	IntCodeProgramImage() = default;
+
+	std::shared_ptr<const IntCodeProgram>				m_Program;
+	std::shared_ptr<const std::vector<std::int64_t>>	m_Int64Program;
+	std::uint64_t										m_Hash = 0;
+};
+
+template<typename ValuePolicy>
+std::shared_ptr<const std::vector<typename ValuePolicy::Value>> IntCodeProgramImage::GetProgramFor() const
+{
+	using Value = typename ValuePolicy::Value;
+
+	if constexpr (std::is_same_v<Value, IntCodeValue>)
+	{
+		return m_Program;
+	}
+	else if constexpr (std::is_same_v<Value, std::int64_t>)
+	{
+		return m_Int64Program;
+	}
+	else
+	{
+		auto program = std::make_shared<std::vector<Value>>(m_Program->size());
+		for (std::size_t i = 0; i < m_Program->size(); i++)
+		{
+			if (!ValuePolicy::TryFromBigInt((*m_Program)[i], (*program)[i]))
+			{
+				return nullptr;
+			}
+		}
+
+		return program;
+	}
+}
+
+/***********************************************************************************************
+
+ Process-wide cache of the program images loaded from files.
+
+ Images are keyed by path and by a hash of the file content: loading the same file
+ twice only reads it, and an edited file is parsed again. Thread safe.
+
+************************************************************************************************/
+
+class IntCodeProgramRegistry
+{
+public:
+	static IntCodeProgramRegistry& Get();
+
+	// Returns an empty image if the file can't be read
+	IntCodeProgramImagePtr Load(const std::string& filename);
+
+	void Clear();
+
+private:
+	struct Entry
+	{
+		std::uint64_t			m_FileHash;
+		IntCodeProgramImagePtr	m_Image;
+	};
+
+	IntCodeProgramRegistry() = default;
+
+	std::mutex								m_Mutex;
+	std::unordered_map<std::string, Entry>	m_Images;
+};
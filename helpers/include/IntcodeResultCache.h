@@ -0,0 +1,72 @@
+#pragma once
+
+#include <IntcodeProgramImage.h>
+#include <IntcodeValuePolicies.h>
+
+#include <atomic>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+/***********************************************************************************************
+
+ On-disk memoization of whole IntCode runs: the outputs a program gives for a sequence of
+ inputs, for programs which only depend on their inputs and run to completion.
+
+ Results go to <image hash>-<inputs hash>.result in the cache's directory, which holds the
+ program's hash and size and every input, all checked on load: a changed program hashes
+ differently and simply misses. Results are written to a temporary file renamed over the
+ final one, so any number of threads and processes can share the directory, and readers
+ only ever see whole results.
+
+ Disabled unless the environment variable INTCODE_CACHE_DIRECTORY names a directory, or
+ SetDirectory is called (before any computation, it isn't synchronized).
+
+************************************************************************************************/
+
+class IntCodeResultCache
+{
+public:
+	static IntCodeResultCache& Get();
+
+	// An empty path disables the cache
+	void SetDirectory(const std::filesystem::path& directory);
+	inline bool IsEnabled() const { return !m_Directory.empty(); }
+
+	// False if the run was never stored, or the cache is disabled. Always false while traces are
+	// recorded (see IntCodeTraceRecorder): runs go through computers again, and get recorded.
+	// Corrupted results miss too.
+	bool TryLoad(const IntCodeProgramImage& image, std::span<const IntCodeValue> inputs, std::vector<IntCodeValue>& outputs) const;
+	void Store(const IntCodeProgramImage& image, std::span<const IntCodeValue> inputs, std::span<const IntCodeValue> outputs);
+
+	// The stored outputs of the run, or those of run() (which returns false if they can't be
+	// stored, e.g. when the program didn't halt), stored on the way.
+	template<typename Run>
+	std::vector<IntCodeValue> GetOrRun(const IntCodeProgramImage& image, std::span<const IntCodeValue> inputs, Run&& run);
+
+private:
+	IntCodeResultCache();
+
+	std::filesystem::path GetPath(const IntCodeProgramImage& image, std::span<const IntCodeValue> inputs) const;
+
+	std::filesystem::path		m_Directory;
+	std::atomic<std::uint64_t>	m_TemporaryCount = 0;
+};
+
+template<typename Run>
+std::vector<IntCodeValue> IntCodeResultCache::GetOrRun(const IntCodeProgramImage& image, std::span<const IntCodeValue> inputs, Run&& run)
+{
+	std::vector<IntCodeValue> outputs;
+	if (TryLoad(image, inputs, outputs))
+	{
+		return outputs;
+	}
+
+	outputs.clear();
+	if (run(outputs) && IsEnabled())
+	{
+		Store(image, inputs, outputs);
+	}
+
+	return outputs;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <IntcodeValuePolicies.h>
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+/***********************************************************************************************
+
+ The binary format IntCode computers save their whole state in (see SaveSnapshot).
+
+ A snapshot only holds what changed since the program was loaded: it can only be restored
+ into a computer running the same program, which the header checks by the image's hash.
+ In order:
+
+	- the header: magic, byte order mark, kind of values, image hash and size
+	- instruction pointer, relative base, status and instruction count
+	- pending inputs, then pending outputs: a count, then the values
+	- pages of memory not shared with the program as loaded, by increasing address:
+	  a count, then for each page its first address and every value it holds
+
+ Integers are 64 bits wide, in native byte order (the mark tells whether it matches).
+ Fixed width values are stored as they are in memory, so every page of a 64 bit computer is
+ laid out exactly as an IntCodeMemory::Page, 8 bytes aligned from the start of the snapshot:
+ a mapped snapshot can be read in place. Unbounded values are a sign, a byte count, and
+ the magnitude's bytes, most significant first.
+
+************************************************************************************************/
+
+class IntCodeSnapshot
+{
+public:
+	enum class ValueKind : std::uint64_t
+	{
+		Int64,
+		Int128,
+		BigInt
+	};
+
+	struct Header
+	{
+		ValueKind		m_ValueKind = ValueKind::Int64;
+		std::uint64_t	m_ImageHash = 0;
+		std::uint64_t	m_ImageSize = 0;
+	};
+
+	template<typename ValuePolicy>
+	static constexpr ValueKind GetValueKind();
+
+	static void WriteHeader(std::ostream& output, const Header& header);
+
+	// Fails on anything that isn't a snapshot, or was saved with a different byte order
+	static bool ReadHeader(std::istream& input, Header& header);
+
+	static void WriteInteger(std::ostream& output, std::uint64_t value);
+	static bool ReadInteger(std::istream& input, std::uint64_t& value);
+
+	template<typename ValuePolicy>
+	static void WriteValues(std::ostream& output, const typename ValuePolicy::Value* values, std::size_t count);
+
+	template<typename ValuePolicy>
+	static bool ReadValues(std::istream& input, typename ValuePolicy::Value* values, std::size_t count);
+
+private:
+	static void WriteBigInt(std::ostream& output, const IntCodeValue& value);
+	static bool ReadBigInt(std::istream& input, IntCodeValue& value);
+};
+
+template<typename ValuePolicy>
+constexpr IntCodeSnapshot::ValueKind IntCodeSnapshot::GetValueKind()
+{
+	if constexpr (ValuePolicy::IsUnbounded)
+	{
+		return ValueKind::BigInt;
+	}
+	else
+	{
+		static_assert(sizeof(typename ValuePolicy::Value) == 8 || sizeof(typename ValuePolicy::Value) == 16, "Unexpected fixed width");
+		return sizeof(typename ValuePolicy::Value) == 8 ? ValueKind::Int64 : ValueKind::Int128;
+	}
+}
+
+template<typename ValuePolicy>
+void IntCodeSnapshot::WriteValues(std::ostream& output, const typename ValuePolicy::Value* values, std::size_t count)
+{
+	if constexpr (ValuePolicy::IsUnbounded)
+	{
+		for (std::size_t i = 0; i < count; i++)
+		{
+			WriteBigInt(output, values[i]);
+		}
+	}
+	else
+	{
+		output.write(reinterpret_cast<const char*>(values), count * sizeof(typename ValuePolicy::Value));
+	}
+}
+
+template<typename ValuePolicy>
+bool IntCodeSnapshot::ReadValues(std::istream& input, typename ValuePolicy::Value* values, std::size_t count)
+{
+	if constexpr (ValuePolicy::IsUnbounded)
+	{
+		for (std::size_t i = 0; i < count; i++)
+		{
+			if (!ReadBigInt(input, values[i]))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+	else
+	{
+		return static_cast<bool>(input.read(reinterpret_cast<char*>(values), count * sizeof(typename ValuePolicy::Value)));
+	}
+}
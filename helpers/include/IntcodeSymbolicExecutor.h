@@ -0,0 +1,138 @@
+#pragma once
+
+#include <IntcodeDefinitions.h>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <span>
+#include <tuple>
+#include <vector>
+
+/***********************************************************************************************
+
+ Expressions over a few symbols, as a DAG: equal subexpressions are built once and shared.
+
+ Constants are folded as nodes get built, so an expression not depending on any symbol is
+ always a single constant node. Nodes are numbered in creation order, so the operands of a
+ node always come before it.
+
+ Unknown nodes stand for values which can't be expressed (a load at an address depending
+ on a symbol): anything built on them can't be evaluated.
+
+************************************************************************************************/
+
+class IntCodeExpressionGraph
+{
+public:
+	using NodeId = std::uint32_t;
+
+	enum class NodeKind : std::uint8_t
+	{
+		Constant,
+		Symbol,
+		Unknown,
+		Add,
+		Multiply,
+		LessThan,
+		Equals
+	};
+
+	struct Node
+	{
+		NodeKind				m_Kind;
+
+		// Operators only, for symbols the first one is the symbol index
+		std::array<NodeId, 2>	m_Operands = {};
+
+		// Constants only
+		IntCodeValue			m_Value;
+	};
+
+	// Exponent of each symbol, and the coefficient of each monomial (never zero)
+	using Monomial = std::vector<std::uint32_t>;
+	using Polynomial = std::map<Monomial, IntCodeValue>;
+
+	NodeId MakeConstant(const IntCodeValue& value);
+	NodeId MakeSymbol(std::uint32_t index);
+	NodeId MakeUnknown();
+	NodeId MakeOperation(NodeKind kind, NodeId lhs, NodeId rhs);
+
+	inline const Node& GetNode(NodeId node) const { return m_Nodes[node]; }
+	inline std::size_t GetNodeCount() const { return m_Nodes.size(); }
+	inline std::uint32_t GetSymbolCount() const { return m_SymbolCount; }
+
+	bool IsConstant(NodeId node, IntCodeValue& value) const;
+
+	// Fails on unknowns, symbols must hold a value for every symbol index
+	bool TryEvaluate(NodeId node, std::span<const IntCodeValue> symbols, IntCodeValue& value) const;
+
+	// Fails on unknowns and comparisons, or if the polynomial grows past maxTerms
+	bool TryExpand(NodeId node, Polynomial& polynomial, std::size_t maxTerms = 4096) const;
+
+	// "((s0 * 3) + s1)"
+	void Write(std::ostream& output, NodeId node) const;
+
+private:
+	NodeId AddNode(Node node);
+
+	// The nodes reachable from this one, operands first
+	std::vector<NodeId> GetReachableNodes(NodeId node) const;
+
+	std::vector<Node>										m_Nodes;
+	std::uint32_t											m_SymbolCount = 0;
+
+	std::map<IntCodeValue, NodeId>							m_Constants;
+	std::map<std::uint32_t, NodeId>							m_Symbols;
+	std::map<std::tuple<NodeKind, NodeId, NodeId>, NodeId>	m_Operations;
+};
+
+/***********************************************************************************************
+
+ Runs an IntCode program with some of its cells (typically Day 2's noun and verb) standing
+ for symbols, to get what every cell ends up holding as an expression of those symbols.
+
+ Only straight line code can be run that way: ADD, MUL, LT, EQ, RBS and HLT, and jumps whose
+ condition and target don't depend on any symbol. Execution stops on I/O, on a jump which
+ depends on a symbol, and on an instruction or a write address which depends on one. Reads
+ at an address depending on a symbol give an unknown value: harmless as long as it is
+ overwritten before it matters.
+
+************************************************************************************************/
+
+class IntCodeSymbolicExecutor : public IntCodeDefinitions
+{
+public:
+	using NodeId = IntCodeExpressionGraph::NodeId;
+
+	// The cell at symbolicCells[i] starts as symbol i
+	IntCodeSymbolicExecutor(const IntCodeProgram& program, std::span<const IntCodeAddress> symbolicCells);
+
+	// True if the program halted. Fails on anything it can't follow, or past maxInstructions.
+	bool Execute(std::size_t maxInstructions = 1 << 20);
+
+	// What the cell holds, as it is now
+	NodeId GetCell(IntCodeAddress address) const;
+
+	inline const IntCodeExpressionGraph& GetGraph() const { return m_Graph; }
+	inline IntCodeExpressionGraph& GetGraph() { return m_Graph; }
+
+private:
+	// Programs writing further than that aren't worth it
+	static constexpr IntCodeAddress MaxMemorySize = IntCodeAddress(1) << 20;
+
+	// Fails if the parameter depends on a symbol, or if the address is invalid
+	bool TryGetParameterAddress(ParameterMode mode, NodeId parameter, IntCodeAddress& address) const;
+
+	// Unknown if the address depends on a symbol. Fails if the address is invalid.
+	bool TryReadParameter(ParameterMode mode, NodeId parameter, NodeId& value);
+	bool TryStore(IntCodeAddress address, NodeId value);
+
+	IntCodeExpressionGraph		m_Graph;
+	std::vector<NodeId>			m_Memory;
+	NodeId						m_Zero;
+
+	IntCodeAddress				m_InstructionPointer = 0;
+	IntCodeValue				m_RelativeBase = 0;
+};
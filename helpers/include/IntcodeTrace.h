@@ -0,0 +1,251 @@
+#pragma once
+
+#include <IntcodeValuePolicies.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <span>
+#include <vector>
+
+class IntCodeTrace;
+using IntCodeTracePtr = std::shared_ptr<IntCodeTrace>;
+
+/***********************************************************************************************
+
+ Everything a program was given and gave back during a run, in order: replaying it drives any
+ kind of computer exactly like the original run did, and tells whether it still gives the same
+ outputs. Solvers all feed and drain computers their own way, traces make them comparable.
+
+ Each event is stamped with the instruction count of the computer at the time, which is what
+ time means for a deterministic program: executions are replayed with the same budgets, and
+ throughputs are computed from the instructions the recording ran, whatever the computer
+ replaying it does with them.
+
+ A trace is only tied to a program by its image's hash and size. In a file, as 64 bit
+ integers in native byte order: magic, byte order mark, image hash and size, event count,
+ then the kind, argument and instruction count of each event, followed by its value for
+ kinds which have one (see IntCodeSnapshot for the encoding of values).
+
+************************************************************************************************/
+
+class IntCodeTrace
+{
+public:
+	enum class EventKind : std::uint64_t
+	{
+		Reset,
+		PauseOnOutput,		// Argument: whether it is enabled
+		Store,				// Argument: address, value: what is stored
+		Load,				// Argument: address, value: what was read
+		SetExecutionState,	// Argument: instruction pointer, value: relative base
+		Input,				// Value: what was fed
+		Output,				// Value: what was drained
+		Execute,			// Argument: instruction budget
+		Watch,				// Argument: address of a cell for the next ExecuteUntilAccess
+		ExecuteUntilAccess
+	};
+
+	struct Event
+	{
+		EventKind		m_Kind = EventKind::Reset;
+		std::uint64_t	m_Argument = 0;
+		std::uint64_t	m_InstructionCount = 0;
+		IntCodeValue	m_Value;
+	};
+
+	struct ReplayResult
+	{
+		static constexpr std::size_t NoMismatch = std::numeric_limits<std::size_t>::max();
+
+		inline bool IsMatching() const { return m_FirstMismatch == NoMismatch; }
+		inline double GetInstructionsPerSecond() const { return m_Duration.count() > 0 ? m_InstructionCount / m_Duration.count() : 0.0; }
+
+		// Index of the first event the computer didn't reproduce
+		std::size_t						m_FirstMismatch = NoMismatch;
+
+		// Of the recording, and of the executions replayed
+		std::uint64_t					m_InstructionCount = 0;
+		std::chrono::duration<double>	m_Duration {};
+	};
+
+	IntCodeTrace() = default;
+	IntCodeTrace(std::uint64_t imageHash, std::uint64_t imageSize);
+
+	void Record(EventKind kind, std::uint64_t argument, const IntCodeValue& value, std::uint64_t instructionCount);
+
+	// Resets the computer, then replays every event on it until the first mismatch.
+	// Works with any computer running on IntCodeValue (IntCodeComputer, with or without JIT,
+	// ProfiledIntCodeComputer, the arbitrary precision BasicIntCodeComputer...) or offering
+	// the same interface: events the computer can't replay count as mismatches.
+	template<typename Computer>
+	ReplayResult Replay(Computer& computer) const;
+
+	void Write(std::ostream& output) const;
+
+	// Fails on anything that isn't a trace, or was written with a different byte order
+	bool Read(std::istream& input);
+
+	inline std::uint64_t GetImageHash() const { return m_ImageHash; }
+	inline std::uint64_t GetImageSize() const { return m_ImageSize; }
+	inline const std::vector<Event>& GetEvents() const { return m_Events; }
+
+	// Instructions run by the recorded executions, all resets and forks included
+	std::uint64_t GetExecutedInstructionCount() const;
+
+private:
+	static bool HasValue(EventKind kind);
+
+	std::uint64_t		m_ImageHash = 0;
+	std::uint64_t		m_ImageSize = 0;
+	std::vector<Event>	m_Events;
+};
+
+template<typename Computer>
+IntCodeTrace::ReplayResult IntCodeTrace::Replay(Computer& computer) const
+{
+	ReplayResult result;
+	result.m_InstructionCount = GetExecutedInstructionCount();
+
+	std::vector<IntCodeAddress> watchedCells;
+
+	computer.Reset();
+	for (std::size_t i = 0; i < m_Events.size() && result.IsMatching(); i++)
+	{
+		const Event& event = m_Events[i];
+		bool isMatching = true;
+
+		switch (event.m_Kind)
+		{
+		case EventKind::Reset:
+			computer.Reset();
+			break;
+
+		case EventKind::PauseOnOutput:
+			if constexpr (requires { computer.SetPauseOnOutput(true); })
+			{
+				computer.SetPauseOnOutput(event.m_Argument != 0);
+			}
+			else
+			{
+				isMatching = false;
+			}
+			break;
+
+		case EventKind::Store:
+			if constexpr (requires { computer.SetValueAt(IntCodeAddress(), event.m_Value); })
+			{
+				computer.SetValueAt(static_cast<IntCodeAddress>(event.m_Argument), event.m_Value);
+			}
+			else
+			{
+				isMatching = false;
+			}
+			break;
+
+		case EventKind::Load:
+			isMatching = computer.GetValueAt(static_cast<IntCodeAddress>(event.m_Argument)) == event.m_Value;
+			break;
+
+		case EventKind::SetExecutionState:
+			if constexpr (requires { computer.SetExecutionState(IntCodeAddress(), event.m_Value); })
+			{
+				computer.SetExecutionState(static_cast<IntCodeAddress>(event.m_Argument), event.m_Value);
+			}
+			else
+			{
+				isMatching = false;
+			}
+			break;
+
+		case EventKind::Input:
+			isMatching = computer.FeedInputs(std::span(&event.m_Value, 1)) == 1;
+			break;
+
+		case EventKind::Output:
+		{
+			IntCodeValue output;
+			isMatching = computer.DrainOutputs(std::span(&output, 1)) == 1 && output == event.m_Value;
+			break;
+		}
+
+		case EventKind::Execute:
+		{
+			const auto start = std::chrono::steady_clock::now();
+			if constexpr (requires { computer.Execute(event.m_Argument); })
+			{
+				computer.Execute(event.m_Argument);
+			}
+			else if (event.m_Argument == std::numeric_limits<std::uint64_t>::max())
+			{
+				computer.Execute();
+			}
+			else
+			{
+				isMatching = false;
+			}
+			result.m_Duration += std::chrono::steady_clock::now() - start;
+			break;
+		}
+
+		case EventKind::Watch:
+			watchedCells.push_back(static_cast<IntCodeAddress>(event.m_Argument));
+			break;
+
+		case EventKind::ExecuteUntilAccess:
+			if constexpr (requires { computer.ExecuteUntilAccess(std::span<const IntCodeAddress>(watchedCells)); })
+			{
+				const auto start = std::chrono::steady_clock::now();
+				computer.ExecuteUntilAccess(std::span<const IntCodeAddress>(watchedCells));
+				result.m_Duration += std::chrono::steady_clock::now() - start;
+			}
+			else
+			{
+				isMatching = false;
+			}
+			watchedCells.clear();
+			break;
+		}
+
+		if (!isMatching)
+		{
+			result.m_FirstMismatch = i;
+		}
+	}
+
+	return result;
+}
+
+/***********************************************************************************************
+
+ Process-wide switch recording every IntCodeComputer into trace files: when the environment
+ variable INTCODE_TRACE_DIRECTORY names a directory, each computer built from a program (and
+ each fork, which starts with its parent's events) records a trace, written in that directory
+ as <image hash>-<index>.trace once the computer is gone. Running the solvers that way builds
+ a corpus of real workloads for the IntcodeReplay tool.
+
+ Computers only go through the trace files of their own thread, any number of them can record.
+
+************************************************************************************************/
+
+class IntCodeTraceRecorder
+{
+public:
+	static IntCodeTraceRecorder& Get();
+
+	inline bool IsEnabled() const { return !m_Directory.empty(); }
+
+	// A trace starting with the given events. Written to a file once released if the recorder
+	// is enabled, as long as it executed anything.
+	IntCodeTracePtr CreateTrace(IntCodeTrace trace);
+
+private:
+	IntCodeTraceRecorder();
+
+	std::filesystem::path		m_Directory;
+	std::atomic<std::uint64_t>	m_TraceCount = 0;
+};
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <boost/multiprecision/cpp_int.hpp>
+
+using IntCodeAddress = std::size_t;
+using IntCodeValue = boost::multiprecision::cpp_int;
+using IntCodeProgram = std::vector<IntCodeValue>;
+
+#if defined(__SIZEOF_INT128__)
+#define INTCODE_HAS_INT128 1
+#else
+#define INTCODE_HAS_INT128 0
+#endif
+
+// std::make_unsigned is not specialized for __int128 in strict ISO mode
+template<typename T>
+struct IntCodeMakeUnsigned { using type = std::make_unsigned_t<T>; };
+
+#if INTCODE_HAS_INT128
+template<>
+struct IntCodeMakeUnsigned<__int128> { using type = unsigned __int128; };
+#endif
+
+/***********************************************************************************************
+
+ A ValuePolicy tells the IntCode VM which integer type it computes with.
+
+ Fixed width policies report an overflow instead of wrapping around, so that the caller
+ can retry the very same instruction with a wider policy (see IntCodeComputer).
+ The unbounded policy never overflows, but every operation is a bignum operation.
+
+************************************************************************************************/
+
+template<typename FixedWidthValue>
+struct IntCodeFixedWidthPolicy
+{
+	using Value = FixedWidthValue;
+	using UnsignedValue = typename IntCodeMakeUnsigned<FixedWidthValue>::type;
+
+	static constexpr bool IsUnbounded = false;
+
+	static inline bool TryAdd(Value lhs, Value rhs, Value& result)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return !__builtin_add_overflow(lhs, rhs, &result);
+#else
+		if ((rhs > 0 && lhs > GetMax() - rhs) || (rhs < 0 && lhs < GetMin() - rhs))
+		{
+			return false;
+		}
+
+		result = lhs + rhs;
+		return true;
+#endif
+	}
+
+	static inline bool TryMul(Value lhs, Value rhs, Value& result)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return !__builtin_mul_overflow(lhs, rhs, &result);
+#else
+		if (lhs != 0 && rhs != 0)
+		{
+			const bool sameSign = (lhs > 0) == (rhs > 0);
+			if (sameSign && (lhs > 0 ? lhs > GetMax() / rhs : lhs < GetMax() / rhs))
+			{
+				return false;
+			}
+
+			if (!sameSign && (lhs > 0 ? rhs < GetMin() / lhs : lhs < GetMin() / rhs))
+			{
+				return false;
+			}
+		}
+
+		result = lhs * rhs;
+		return true;
+#endif
+	}
+
+	static inline bool TryToAddress(Value value, IntCodeAddress& address)
+	{
+		if (value < 0 || static_cast<UnsignedValue>(value) > std::numeric_limits<IntCodeAddress>::max())
+		{
+			return false;
+		}
+
+		address = static_cast<IntCodeAddress>(value);
+		return true;
+	}
+
+	static inline int ToInt(Value value) { return static_cast<int>(value); }
+
+	static bool TryFromBigInt(const IntCodeValue& value, Value& result)
+	{
+		static const IntCodeValue Min = ToBigInt(GetMin());
+		static const IntCodeValue Max = ToBigInt(GetMax());
+
+		if (value < Min || value > Max)
+		{
+			return false;
+		}
+
+		if constexpr (sizeof(Value) <= sizeof(std::int64_t))
+		{
+			result = value.template convert_to<Value>();
+		}
+		else
+		{
+			// Wider than any builtin conversion Boost is guaranteed to provide:
+			// go through the two's complement representation, 64 bits at a time.
+			const IntCodeValue twosComplement = value < 0 ? value + (IntCodeValue(1) << (8 * sizeof(Value))) : value;
+
+			UnsignedValue bits = 0;
+			for (std::size_t shift = 8 * sizeof(Value); shift > 0; shift -= 64)
+			{
+				const IntCodeValue chunk = (twosComplement >> (shift - 64)) & std::numeric_limits<std::uint64_t>::max();
+				bits = (bits << 64) | chunk.template convert_to<std::uint64_t>();
+			}
+
+			result = static_cast<Value>(bits);
+		}
+
+		return true;
+	}
+
+	static IntCodeValue ToBigInt(Value value)
+	{
+		if constexpr (sizeof(Value) <= sizeof(std::int64_t))
+		{
+			return IntCodeValue(value);
+		}
+		else
+		{
+			const bool isNegative = value < 0;
+			auto magnitude = static_cast<UnsignedValue>(value);
+			magnitude = isNegative ? ~magnitude + 1 : magnitude;
+
+			IntCodeValue result = 0;
+			for (std::size_t shift = 8 * sizeof(Value); shift > 0; shift -= 64)
+			{
+				result <<= 64;
+				result |= static_cast<std::uint64_t>(magnitude >> (shift - 64));
+			}
+
+			return isNegative ? IntCodeValue(-result) : result;
+		}
+	}
+
+private:
+	// Same as above, std::numeric_limits might not know about __int128
+	static constexpr Value GetMax() { return static_cast<Value>(~UnsignedValue(0) >> 1); }
+	static constexpr Value GetMin() { return -GetMax() - 1; }
+};
+
+using IntCodeInt64Policy = IntCodeFixedWidthPolicy<std::int64_t>;
+
+#if INTCODE_HAS_INT128
+using IntCodeInt128Policy = IntCodeFixedWidthPolicy<__int128>;
+#endif
+
+struct IntCodeBigIntPolicy
+{
+	using Value = IntCodeValue;
+
+	static constexpr bool IsUnbounded = true;
+
+	static inline bool TryAdd(const Value& lhs, const Value& rhs, Value& result) { result = lhs + rhs; return true; }
+	static inline bool TryMul(const Value& lhs, const Value& rhs, Value& result) { result = lhs * rhs; return true; }
+
+	static inline bool TryToAddress(const Value& value, IntCodeAddress& address)
+	{
+		if (value < 0 || value > std::numeric_limits<IntCodeAddress>::max())
+		{
+			return false;
+		}
+
+		address = value.convert_to<IntCodeAddress>();
+		return true;
+	}
+
+	static inline int ToInt(const Value& value) { return value.convert_to<int>(); }
+
+	static inline bool TryFromBigInt(const IntCodeValue& value, Value& result) { result = value; return true; }
+	static inline const IntCodeValue& ToBigInt(const Value& value) { return value; }
+};
@@ -1,8 +1,22 @@
 #pragma once
 
-#include <vector>
-#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <type_traits>
+#include <utility>
+#include <vector>
+
+template<typename Container>
+struct PermutationIndicesContainer
+{
+	using Type = std::vector<int>;
+};
+
+template<typename T, std::size_t N>
+struct PermutationIndicesContainer<std::array<T, N>>
+{
+	using Type = std::array<int, N>;
+};
 
 /***********************************************************************************************
 
@@ -10,75 +24,138 @@
 
  https://www.geeksforgeeks.org/johnson-trotter-algorithm/
 
+ Steps follow Knuth's plain changes (TAOCP 7.2.1.2, algorithm P): the same order, but each
+ element keeps how many smaller ones are on its right and which way it goes, so finding the
+ next swap is O(1) amortized instead of a scan. Elements are told apart by their position,
+ not their value: repeated values give repeated permutations, all of them visited.
+
+ Those counts are the digits of the permutation's rank in a reflected mixed radix, so Rank
+ and Unrank are O(n) and O(n^2): Unrank lets workers each walk their own range of ranks.
+ Ranks fit 64 bits up to 20 elements.
+
+ With a std::array (see FixedPermutationGenerator) nothing is ever allocated, and the whole
+ generator can run in constant expressions.
+
 ************************************************************************************************/
 
 template<typename T, typename Container = std::vector<T>, std::enable_if_t<!std::is_reference_v<Container>, bool> = 0>
 class PermutationGenerator
 {
 public:
-	PermutationGenerator(Container container)
+	constexpr PermutationGenerator(Container container)
 		: m_ContainedData(container)
+		, m_InitialData(std::move(container))
 	{
-		for (std::size_t i = 1; i <= m_ContainedData.size(); i++)
+		if constexpr (std::is_same_v<IndicesContainer, std::vector<int>>)
 		{
-			m_PermutationIndices.push_back(-i);
+			m_SmallerOnRight.resize(m_ContainedData.size());
+			m_Directions.resize(m_ContainedData.size());
+		}
+
+		for (std::size_t i = 0; i < m_ContainedData.size(); i++)
+		{
+			m_SmallerOnRight[i] = 0;
+			m_Directions[i] = 1;
 		}
 	}
 
-	bool ComputeNextPermutation()
+	// Returns false, staying on the last permutation, once they have all been visited
+	constexpr bool ComputeNextPermutation()
 	{
-		IndicesContainer::iterator maxMovableIt = m_PermutationIndices.end();
-		auto maxMovable = 0;
-		for (auto it = m_PermutationIndices.begin(); it != m_PermutationIndices.end(); it++)
+		const int size = static_cast<int>(m_ContainedData.size());
+
+		// Elements above the one moving which are at the far left of their sweep
+		int offset = 0;
+
+		for (int element = size; element > 0; element--)
 		{
-			if (IsMovable(it) && std::abs(*it) > maxMovable)
+			int& smallerOnRight = m_SmallerOnRight[element - 1];
+			int& direction = m_Directions[element - 1];
+
+			const int next = smallerOnRight + direction;
+			if (next == element)
+			{
+				if (element == 1)
+				{
+					Unrank(GetPermutationCount() - 1);
+					return false;
+				}
+				offset++;
+			}
+			else if (next >= 0)
 			{
-				maxMovableIt = it;
-				maxMovable = *it;
+				std::swap(m_ContainedData[element - smallerOnRight + offset - 1], m_ContainedData[element - next + offset - 1]);
+				smallerOnRight = next;
+				return true;
 			}
+
+			// The element reached the end of its sweep, and the next smaller one moves instead
+			direction = -direction;
 		}
 
-		if (maxMovableIt == m_PermutationIndices.end())
+		return false;
+	}
+
+	constexpr std::uint64_t Rank() const
+	{
+		std::uint64_t rank = 0;
+		for (std::size_t element = 1; element <= m_ContainedData.size(); element++)
 		{
-			return false;
+			const int smallerOnRight = m_SmallerOnRight[element - 1];
+			const int digit = m_Directions[element - 1] > 0 ? smallerOnRight : static_cast<int>(element) - 1 - smallerOnRight;
+			rank = rank * element + digit;
 		}
+		return rank;
+	}
 
-		const int swapDirection = maxMovable > 0 ? 1 : -1;
-		std::iter_swap(maxMovableIt, maxMovableIt + swapDirection);
+	// Jumps to the permutation ComputeNextPermutation reaches after rank steps from the start
+	constexpr void Unrank(std::uint64_t rank)
+	{
+		for (std::size_t element = m_ContainedData.size(); element > 0; element--)
+		{
+			const int digit = static_cast<int>(rank % element);
+			rank /= element;
 
-		std::size_t movableIdx = std::distance(m_PermutationIndices.begin(), maxMovableIt);
-		auto movableInCollectionIt = m_ContainedData.begin() + movableIdx;
-		std::iter_swap(movableInCollectionIt, movableInCollectionIt + swapDirection);
+			// Sweeps go back and forth as the smaller elements move
+			m_Directions[element - 1] = rank % 2 == 0 ? 1 : -1;
+			m_SmallerOnRight[element - 1] = m_Directions[element - 1] > 0 ? digit : static_cast<int>(element) - 1 - digit;
+		}
 
-		for (auto& permutationIdx : m_PermutationIndices)
+		// Each element goes in on the left of as many smaller ones as it has on its right
+		for (std::size_t element = 1; element <= m_ContainedData.size(); element++)
 		{
-			if (std::abs(permutationIdx) > std::abs(maxMovable))
+			const std::size_t position = element - 1 - m_SmallerOnRight[element - 1];
+			for (std::size_t i = element - 1; i > position; i--)
 			{
-				permutationIdx *= -1;
+				m_ContainedData[i] = std::move(m_ContainedData[i - 1]);
 			}
+			m_ContainedData[position] = m_InitialData[element - 1];
 		}
+	}
 
-		return true;
+	constexpr std::uint64_t GetPermutationCount() const
+	{
+		std::uint64_t count = 1;
+		for (std::size_t element = 2; element <= m_ContainedData.size(); element++)
+		{
+			count *= element;
+		}
+		return count;
 	}
 
-	inline Container& GetCurrentPermutation() { return m_ContainedData; }
+	inline constexpr Container& GetCurrentPermutation() { return m_ContainedData; }
+	inline constexpr const Container& GetCurrentPermutation() const { return m_ContainedData; }
 
 private:
-	using IndicesContainer = std::vector<int>;
+	using IndicesContainer = typename PermutationIndicesContainer<Container>::Type;
 
 	Container m_ContainedData;
-	IndicesContainer m_PermutationIndices;
-
-	bool IsMovable(IndicesContainer::iterator it)
-	{
-		int swapDirection = *it > 0 ? 1 : -1;
-		IndicesContainer::iterator next = (it == m_PermutationIndices.begin() && swapDirection < 0) ? m_PermutationIndices.end() : it + swapDirection;
+	Container m_InitialData;
 
-		if (next == m_PermutationIndices.end())
-		{
-			return false;
-		}
+	// For the element initially at index i
+	IndicesContainer m_SmallerOnRight {};
+	IndicesContainer m_Directions {};
+};
 
-		return std::abs(*it) > std::abs(*next);
-	}
-};
\ No newline at end of file
+template<typename T, std::size_t N>
+using FixedPermutationGenerator = PermutationGenerator<T, std::array<T, N>>;
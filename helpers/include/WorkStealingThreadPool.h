@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************************************************
+
+ A fixed set of worker threads, each with its own task queue.
+
+ Workers run their own queue newest first (the data a task just touched is still hot),
+ and when it runs dry they steal the oldest task of another worker. Tasks submitted from
+ a worker go to that worker's queue, anything else is spread round robin.
+
+ Wait() blocks until every task completed, including the ones submitted by other tasks,
+ and rethrows the first exception a task let through.
+
+************************************************************************************************/
+
+class WorkStealingThreadPool
+{
+public:
+	using Task = std::function<void()>;
+
+	// 0 means one thread per hardware thread
+	explicit WorkStealingThreadPool(std::size_t threadCount = 0);
+	~WorkStealingThreadPool();
+
+	WorkStealingThreadPool(const WorkStealingThreadPool& other) = delete;
+	WorkStealingThreadPool& operator=(const WorkStealingThreadPool& other) = delete;
+
+	void Submit(Task task);
+	void Wait();
+
+	inline std::size_t GetThreadCount() const { return m_Threads.size(); }
+
+private:
+	struct WorkerQueue
+	{
+		std::mutex			m_Mutex;
+		std::deque<Task>	m_Tasks;
+	};
+
+	void WorkerLoop(std::size_t workerIndex);
+	bool TryPopTask(std::size_t workerIndex, Task& task);
+	bool TryStealTask(std::size_t thiefIndex, Task& task);
+	void RunTask(Task& task);
+
+	std::vector<std::unique_ptr<WorkerQueue>>	m_Queues;
+	std::vector<std::thread>					m_Threads;
+
+	std::atomic<std::size_t>					m_NextQueue { 0 };
+	std::atomic<std::size_t>					m_QueuedTasks { 0 };
+	std::atomic<std::size_t>					m_UnfinishedTasks { 0 };
+
+	std::mutex									m_StateMutex;
+	std::condition_variable						m_TaskAvailable;
+	std::condition_variable						m_AllTasksFinished;
+	std::exception_ptr							m_FirstException;
+	bool										m_IsStopping = false;
+};
@@ -0,0 +1,812 @@
+#include <IntcodeBatch.h>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define INTCODE_BATCH_HAS_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define INTCODE_BATCH_HAS_AVX2 0
+#endif
+
+// MSVC lets any function use any intrinsic, GCC and Clang want to be told
+#if defined(__GNUC__) || defined(__clang__)
+#define INTCODE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define INTCODE_TARGET_AVX2
+#endif
+
+namespace
+{
+	constexpr std::int64_t NoInstructionPointer = std::numeric_limits<std::int64_t>::max();
+
+	// Lanes are padded up to a full AVX2 register
+	constexpr std::size_t LaneAlignment = 4;
+
+	constexpr std::int64_t ArithmeticLength = 4;
+	constexpr std::int64_t JumpLength = 3;
+
+	// A parameter of an instruction executed together: either a row of memory or an immediate
+	struct BatchOperand
+	{
+		const std::int64_t* m_Row = nullptr;
+		std::int64_t m_Immediate = 0;
+
+		inline std::int64_t Get(std::size_t lane) const { return m_Row ? m_Row[lane] : m_Immediate; }
+	};
+}
+
+// Every kernel only touches the lanes selected by mask. Arithmetic and comparisons also move
+// the instruction pointer of those lanes past the instruction, jumps set it to wherever
+// they go. Lanes that would overflow are left alone, and make the kernel return true.
+struct IntCodeBatchKernels
+{
+	std::int64_t (*m_MinActive)(const std::int64_t* values, const std::int64_t* activeMask, std::size_t laneCount);
+	void (*m_SelectLanes)(const std::int64_t* values, const std::int64_t* activeMask, std::int64_t value, std::int64_t* mask, std::size_t laneCount);
+	bool (*m_IsUniform)(const std::int64_t* row, const std::int64_t* mask, std::int64_t value, std::size_t laneCount);
+
+	bool (*m_Add)(BatchOperand lhs, BatchOperand rhs, std::int64_t* out, std::int64_t* instructionPointers, const std::int64_t* mask, std::size_t laneCount);
+	bool (*m_Mul)(BatchOperand lhs, BatchOperand rhs, std::int64_t* out, std::int64_t* instructionPointers, const std::int64_t* mask, std::size_t laneCount);
+	void (*m_LessThan)(BatchOperand lhs, BatchOperand rhs, std::int64_t* out, std::int64_t* instructionPointers, const std::int64_t* mask, std::size_t laneCount);
+	void (*m_Equals)(BatchOperand lhs, BatchOperand rhs, std::int64_t* out, std::int64_t* instructionPointers, const std::int64_t* mask, std::size_t laneCount);
+	void (*m_JumpIfTrue)(BatchOperand condition, BatchOperand target, std::int64_t* instructionPointers, const std::int64_t* mask, std::size_t laneCount);
+	void (*m_JumpIfFalse)(BatchOperand condition, BatchOperand target, std::int64_t* instructionPointers, const std::int64_t* mask, std::size_t laneCount);
+};
+
+namespace ScalarKernels
+{
+	std::int64_t MinActive(const std::int64_t* values, const std::int64_t* activeMask, std::size_t laneCount)
+	{
+		std::int64_t minValue = NoInstructionPointer;
+		for (std::size_t lane = 0; lane < laneCount; lane++)
+		{
+			if (activeMask[lane] && values[lane] < minValue)
+			{
+				minValue = values[lane];
+			}
+		}
+
+		return minValue;
+	}
+
+	void SelectLanes(const std::int64_t* values, const std::int64_t* activeMask, std::int64_t value, std::int64_t* mask, std::size_t laneCount)
+	{
+		for (std::size_t lane = 0; lane < laneCount; lane++)
+		{
+			mask[lane] = activeMask[lane] && values[lane] == value ? -1 : 0;
+		}
+	}
+
+	bool IsUniform(const std::int64_t* row, const std::int64_t* mask, std::int64_t value, std::size_t laneCount)
+	{
+		for (std::size_t lane = 0; lane < laneCount; lane++)
+		{
+			if (mask[lane] && row[lane] != value)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	template<typename Operation>
+	bool Arithmetic(BatchOperand lhs, BatchOperand rhs, std::int64_t* out, std::int64_t* instructionPointers, const std::int64_t* mask, std::size_t laneCount, Operation operation)
+	{
+		bool overflowed = false;
+		for (std::size_t lane = 0; lane < laneCount; lane++)
+		{
+			std::int64_t result;
+			if (!mask[lane])
+			{
+				continue;
+			}
+			else if (!operation(lhs.Get(lane), rhs.Get(lane), result))
+			{
+				overflowed = true;
+			}
+			else
+			{
+				out[lane] = result;
+				instructionPointers[lane] += ArithmeticLength;
+			}
+		}
+
+		return overflowed;
+	}
+
+	bool Add(BatchOperand lhs, BatchOperand rhs, std::int64_t* out, std::int64_t* instructionPointers, const std::int64_t* mask, std::size_t laneCount)
+	{
+		return Arithmetic(lhs, rhs, out, instructionPointers, mask, laneCount, &IntCodeInt64Policy::TryAdd);
+	}
+
+	bool Mul(BatchOperand lhs, BatchOperand rhs, std::int64_t* out, std::int64_t* instructionPointers, const std::int64_t* mask, std::size_t laneCount)
+	{
+		return Arithmetic(lhs, rhs, out, instructionPointers, mask, laneCount, &IntCodeInt64Policy::TryMul);
+	}
+
+	void LessThan(BatchOperand lhs, BatchOperand rhs, std::int64_t* out, std::int64_t* instructionPointers, const std::int64_t* mask, std::size_t laneCount)
+	{
+		for (std::size_t lane = 0; lane < laneCount; lane++)
+		{
+			if (mask[lane])
+			{
+				out[lane] = lhs.Get(lane) < rhs.Get(lane) ? 1 : 0;
+				instructionPointers[lane] += ArithmeticLength;
+			}
+		}
+	}
+
+	void Equals(BatchOperand lhs, BatchOperand rhs, std::int64_t* out, std::int64_t* instructionPointers, const std::int64_t* mask, std::size_t laneCount)
+	{
+		for (std::size_t lane = 0; lane < laneCount; lane++)
+		{
+			if (mask[lane])
+			{
+				out[lane] = lhs.Get(lane) == rhs.Get(lane) ? 1 : 0;
+				instructionPointers[lane] += ArithmeticLength;
+			}
+		}
+	}
+
+	template<bool JumpIfTrue>
+	void Jump(BatchOperand condition, BatchOperand target, std::int64_t* instructionPointers, const std::int64_t* mask, std::size_t laneCount)
+	{
+		for (std::size_t lane = 0; lane < laneCount; lane++)
+		{
+			if (mask[lane])
+			{
+				instructionPointers[lane] = (condition.Get(lane) != 0) == JumpIfTrue ? target.Get(lane) : instructionPointers[lane] + JumpLength;
+			}
+		}
+	}
+
+	const IntCodeBatchKernels* Get();
+}
+
+#if INTCODE_BATCH_HAS_AVX2
+namespace Avx2Kernels
+{
+	INTCODE_TARGET_AVX2 inline __m256i Load(const std::int64_t* values)
+	{
+		return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+	}
+
+	INTCODE_TARGET_AVX2 inline void Store(std::int64_t* values, __m256i vector)
+	{
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(values), vector);
+	}
+
+	INTCODE_TARGET_AVX2 inline void MaskStore(std::int64_t* values, __m256i mask, __m256i vector)
+	{
+		_mm256_maskstore_epi64(reinterpret_cast<long long*>(values), mask, vector);
+	}
+
+	INTCODE_TARGET_AVX2 inline __m256i Load(const BatchOperand& operand, std::size_t lane)
+	{
+		return operand.m_Row ? Load(operand.m_Row + lane) : _mm256_set1_epi64x(operand.m_Immediate);
+	}
+
+	INTCODE_TARGET_AVX2 inline bool IsZero(__m256i vector)
+	{
+		return _mm256_testz_si256(vector, vector);
+	}
+
+	INTCODE_TARGET_AVX2 std::int64_t MinActive(const std::int64_t* values, const std::int64_t* activeMask, std::size_t laneCount)
+	{
+		const __m256i none = _mm256_set1_epi64x(NoInstructionPointer);
+
+		__m256i minValues = none;
+		for (std::size_t lane = 0; lane < laneCount; lane += 4)
+		{
+			const __m256i laneValues = _mm256_blendv_epi8(none, Load(values + lane), Load(activeMask + lane));
+			minValues = _mm256_blendv_epi8(minValues, laneValues, _mm256_cmpgt_epi64(minValues, laneValues));
+		}
+
+		alignas(32) std::int64_t candidates[4];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(candidates), minValues);
+		return *std::min_element(std::begin(candidates), std::end(candidates));
+	}
+
+	INTCODE_TARGET_AVX2 void SelectLanes(const std::int64_t* values, const std::int64_t* activeMask, std::int64_t value, std::int64_t* mask, std::size_t laneCount)
+	{
+		const __m256i selected = _mm256_set1_epi64x(value);
+		for (std::size_t lane = 0; lane < laneCount; lane += 4)
+		{
+			Store(mask + lane, _mm256_and_si256(Load(activeMask + lane), _mm256_cmpeq_epi64(Load(values + lane), selected)));
+		}
+	}
+
+	INTCODE_TARGET_AVX2 bool IsUniform(const std::int64_t* row, const std::int64_t* mask, std::int64_t value, std::size_t laneCount)
+	{
+		const __m256i expected = _mm256_set1_epi64x(value);
+
+		__m256i differences = _mm256_setzero_si256();
+		for (std::size_t lane = 0; lane < laneCount; lane += 4)
+		{
+			differences = _mm256_or_si256(differences, _mm256_andnot_si256(_mm256_cmpeq_epi64(Load(row + lane), expected), Load(mask + lane)));
+		}
+
+		return IsZero(differences);
+	}
+
+	INTCODE_TARGET_AVX2 bool Add(BatchOperand lhs, BatchOperand rhs, std::int64_t* out, std::int64_t* instructionPointers, const std::int64_t* mask, std::size_t laneCount)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i length = _mm256_set1_epi64x(ArithmeticLength);
+
+		__m256i overflowed = zero;
+		for (std::size_t lane = 0; lane < laneCount; lane += 4)
+		{
+			const __m256i laneMask = Load(mask + lane);
+			if (IsZero(laneMask))
+			{
+				continue;
+			}
+
+			const __m256i a = Load(lhs, lane);
+			const __m256i b = Load(rhs, lane);
+			const __m256i result = _mm256_add_epi64(a, b);
+
+			// Signed overflow iff the result has a different sign than both operands
+			const __m256i overflow = _mm256_cmpgt_epi64(zero, _mm256_and_si256(_mm256_xor_si256(a, result), _mm256_xor_si256(b, result)));
+			const __m256i written = _mm256_andnot_si256(overflow, laneMask);
+
+			MaskStore(out + lane, written, result);
+			Store(instructionPointers + lane, _mm256_add_epi64(Load(instructionPointers + lane), _mm256_and_si256(written, length)));
+			overflowed = _mm256_or_si256(overflowed, _mm256_and_si256(overflow, laneMask));
+		}
+
+		return !IsZero(overflowed);
+	}
+
+	INTCODE_TARGET_AVX2 bool Mul(BatchOperand lhs, BatchOperand rhs, std::int64_t* out, std::int64_t* instructionPointers, const std::int64_t* mask, std::size_t laneCount)
+	{
+		// There's no 64 bit multiplication in AVX2, but 32 x 32 bit signed products always fit 64 bits
+		const __m256i belowInt32 = _mm256_set1_epi64x(std::int64_t(std::numeric_limits<std::int32_t>::min()) - 1);
+		const __m256i aboveInt32 = _mm256_set1_epi64x(std::int64_t(std::numeric_limits<std::int32_t>::max()) + 1);
+		const __m256i length = _mm256_set1_epi64x(ArithmeticLength);
+
+		bool overflowed = false;
+		for (std::size_t lane = 0; lane < laneCount; lane += 4)
+		{
+			const __m256i laneMask = Load(mask + lane);
+			if (IsZero(laneMask))
+			{
+				continue;
+			}
+
+			const __m256i a = Load(lhs, lane);
+			const __m256i b = Load(rhs, lane);
+
+			const __m256i aFits = _mm256_and_si256(_mm256_cmpgt_epi64(a, belowInt32), _mm256_cmpgt_epi64(aboveInt32, a));
+			const __m256i bFits = _mm256_and_si256(_mm256_cmpgt_epi64(b, belowInt32), _mm256_cmpgt_epi64(aboveInt32, b));
+			const __m256i written = _mm256_and_si256(_mm256_and_si256(aFits, bFits), laneMask);
+
+			MaskStore(out + lane, written, _mm256_mul_epi32(a, b));
+			Store(instructionPointers + lane, _mm256_add_epi64(Load(instructionPointers + lane), _mm256_and_si256(written, length)));
+
+			const __m256i wide = _mm256_andnot_si256(written, laneMask);
+			if (IsZero(wide))
+			{
+				continue;
+			}
+
+			alignas(32) std::int64_t aValues[4], bValues[4], wideMask[4];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(aValues), a);
+			_mm256_store_si256(reinterpret_cast<__m256i*>(bValues), b);
+			_mm256_store_si256(reinterpret_cast<__m256i*>(wideMask), wide);
+
+			for (std::size_t i = 0; i < 4; i++)
+			{
+				std::int64_t result;
+				if (!wideMask[i])
+				{
+					continue;
+				}
+				else if (!IntCodeInt64Policy::TryMul(aValues[i], bValues[i], result))
+				{
+					overflowed = true;
+				}
+				else
+				{
+					out[lane + i] = result;
+					instructionPointers[lane + i] += ArithmeticLength;
+				}
+			}
+		}
+
+		return overflowed;
+	}
+
+	template<bool IsLessThan>
+	INTCODE_TARGET_AVX2 void Compare(BatchOperand lhs, BatchOperand rhs, std::int64_t* out, std::int64_t* instructionPointers, const std::int64_t* mask, std::size_t laneCount)
+	{
+		const __m256i one = _mm256_set1_epi64x(1);
+		const __m256i length = _mm256_set1_epi64x(ArithmeticLength);
+
+		for (std::size_t lane = 0; lane < laneCount; lane += 4)
+		{
+			const __m256i laneMask = Load(mask + lane);
+			if (IsZero(laneMask))
+			{
+				continue;
+			}
+
+			const __m256i a = Load(lhs, lane);
+			const __m256i b = Load(rhs, lane);
+			const __m256i result = IsLessThan ? _mm256_cmpgt_epi64(b, a) : _mm256_cmpeq_epi64(a, b);
+
+			MaskStore(out + lane, laneMask, _mm256_and_si256(result, one));
+			Store(instructionPointers + lane, _mm256_add_epi64(Load(instructionPointers + lane), _mm256_and_si256(laneMask, length)));
+		}
+	}
+
+	template<bool JumpIfTrue>
+	INTCODE_TARGET_AVX2 void Jump(BatchOperand condition, BatchOperand target, std::int64_t* instructionPointers, const std::int64_t* mask, std::size_t laneCount)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i length = _mm256_set1_epi64x(JumpLength);
+
+		for (std::size_t lane = 0; lane < laneCount; lane += 4)
+		{
+			const __m256i laneMask = Load(mask + lane);
+			if (IsZero(laneMask))
+			{
+				continue;
+			}
+
+			const __m256i isFalse = _mm256_cmpeq_epi64(Load(condition, lane), zero);
+			const __m256i jumps = JumpIfTrue ? _mm256_andnot_si256(isFalse, laneMask) : _mm256_and_si256(isFalse, laneMask);
+
+			const __m256i current = Load(instructionPointers + lane);
+			const __m256i next = _mm256_blendv_epi8(current, _mm256_add_epi64(current, length), laneMask);
+			Store(instructionPointers + lane, _mm256_blendv_epi8(next, Load(target, lane), jumps));
+		}
+	}
+
+	bool IsSupported()
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		int registers[4];
+		__cpuid(registers, 0);
+		if (registers[0] < 7)
+		{
+			return false;
+		}
+
+		// The OS must save the AVX registers too
+		__cpuid(registers, 1);
+		const bool hasOsxsave = (registers[2] & (1 << 27)) != 0;
+		if (!hasOsxsave || (_xgetbv(0) & 0x6) != 0x6)
+		{
+			return false;
+		}
+
+		__cpuidex(registers, 7, 0);
+		return (registers[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+	const IntCodeBatchKernels* Get();
+}
+#endif
+
+const IntCodeBatchKernels* ScalarKernels::Get()
+{
+	static const IntCodeBatchKernels ms_Kernels = { &MinActive, &SelectLanes, &IsUniform, &Add, &Mul, &LessThan, &Equals, &Jump<true>, &Jump<false> };
+	return &ms_Kernels;
+}
+
+#if INTCODE_BATCH_HAS_AVX2
+const IntCodeBatchKernels* Avx2Kernels::Get()
+{
+	static const IntCodeBatchKernels ms_Kernels = { &MinActive, &SelectLanes, &IsUniform, &Add, &Mul, &Compare<true>, &Compare<false>, &Jump<true>, &Jump<false> };
+	return &ms_Kernels;
+}
+#endif
+
+IntCodeBatch::InstructionSet IntCodeBatch::GetBestInstructionSet()
+{
+#if INTCODE_BATCH_HAS_AVX2
+	static const bool ms_HasAvx2 = Avx2Kernels::IsSupported();
+	if (ms_HasAvx2)
+	{
+		return InstructionSet::Avx2;
+	}
+#endif
+
+	return InstructionSet::Scalar;
+}
+
+IntCodeBatch::IntCodeBatch(IntCodeProgramImagePtr image, std::size_t instanceCount, std::size_t memorySize)
+	: IntCodeBatch(std::move(image), instanceCount, memorySize, GetBestInstructionSet())
+{
+}
+
+IntCodeBatch::IntCodeBatch(IntCodeProgramImagePtr image, std::size_t instanceCount, std::size_t memorySize, InstructionSet instructionSet)
+	: m_Image(std::move(image))
+	, m_Kernels(ScalarKernels::Get())
+	, m_InstructionSet(InstructionSet::Scalar)
+	, m_InstanceCount(instanceCount)
+	, m_LaneCount((instanceCount + LaneAlignment - 1) / LaneAlignment * LaneAlignment)
+	, m_MemorySize(static_cast<std::int64_t>(std::max(memorySize, m_Image->GetSize())))
+{
+#if INTCODE_BATCH_HAS_AVX2
+	if (instructionSet == InstructionSet::Avx2 && GetBestInstructionSet() == InstructionSet::Avx2)
+	{
+		m_Kernels = Avx2Kernels::Get();
+		m_InstructionSet = InstructionSet::Avx2;
+	}
+#else
+	(void)instructionSet;
+#endif
+
+	Reset();
+}
+
+void IntCodeBatch::Reset()
+{
+	m_Memory.assign(static_cast<std::size_t>(m_MemorySize) * m_LaneCount, 0);
+
+	m_InstructionPointers.assign(m_LaneCount, 0);
+	m_RelativeBases.assign(m_LaneCount, 0);
+	m_RunningMask.assign(m_LaneCount, 0);
+	m_StepMask.assign(m_LaneCount, 0);
+
+	m_Statuses.assign(m_InstanceCount, ExecutionStatus::NotStarted);
+	m_Faulted.assign(m_InstanceCount, false);
+	m_Inputs.assign(m_InstanceCount, {});
+	m_ReadInputs.assign(m_InstanceCount, 0);
+	m_Outputs.assign(m_InstanceCount, {});
+
+	const auto program = m_Image->GetProgramFor<IntCodeInt64Policy>();
+	if (!program)
+	{
+		// Can't even load it
+		m_Statuses.assign(m_InstanceCount, ExecutionStatus::Overflowed);
+		return;
+	}
+
+	for (std::size_t address = 0; address < program->size(); address++)
+	{
+		std::fill_n(GetRow(address), m_LaneCount, (*program)[address]);
+	}
+
+	std::fill_n(m_RunningMask.begin(), m_InstanceCount, -1);
+}
+
+void IntCodeBatch::SetNounAndVerb(std::size_t instance, std::int64_t noun, std::int64_t verb)
+{
+	StoreValue(instance, 1, noun);
+	StoreValue(instance, 2, verb);
+}
+
+void IntCodeBatch::StoreValue(std::size_t instance, IntCodeAddress address, std::int64_t value)
+{
+	assert(instance < m_InstanceCount);
+
+	if (address >= static_cast<IntCodeAddress>(m_MemorySize))
+	{
+		Stop(instance, ExecutionStatus::Overflowed);
+		return;
+	}
+
+	GetRow(address)[instance] = value;
+}
+
+void IntCodeBatch::FeedInputs(std::size_t instance, std::span<const std::int64_t> inputs)
+{
+	m_Inputs[instance].insert(m_Inputs[instance].end(), inputs.begin(), inputs.end());
+
+	if (m_Statuses[instance] == ExecutionStatus::AwaitingInput)
+	{
+		m_Statuses[instance] = ExecutionStatus::Paused;
+		m_RunningMask[instance] = -1;
+	}
+}
+
+std::int64_t IntCodeBatch::GetValueAt(std::size_t instance, IntCodeAddress address) const
+{
+	assert(instance < m_InstanceCount);
+	return address < static_cast<IntCodeAddress>(m_MemorySize) ? GetRow(address)[instance] : 0;
+}
+
+void IntCodeBatch::Execute()
+{
+	for (std::size_t lane = 0; lane < m_InstanceCount; lane++)
+	{
+		if (m_RunningMask[lane])
+		{
+			m_Statuses[lane] = ExecutionStatus::Running;
+		}
+	}
+
+	while (true)
+	{
+		// Whoever is behind goes first, so that diverged instances get a chance to meet again
+		const std::int64_t instructionPointer = m_Kernels->m_MinActive(m_InstructionPointers.data(), m_RunningMask.data(), m_LaneCount);
+		if (instructionPointer == NoInstructionPointer)
+		{
+			break;
+		}
+
+		m_Kernels->m_SelectLanes(m_InstructionPointers.data(), m_RunningMask.data(), instructionPointer, m_StepMask.data(), m_LaneCount);
+
+		if (!TryExecuteTogether(instructionPointer))
+		{
+			for (std::size_t lane = 0; lane < m_InstanceCount; lane++)
+			{
+				if (m_StepMask[lane])
+				{
+					ExecuteAlone(lane);
+				}
+			}
+		}
+	}
+}
+
+bool IntCodeBatch::TryExecuteTogether(std::int64_t instructionPointer)
+{
+	if (instructionPointer < 0 || instructionPointer >= m_MemorySize)
+	{
+		return false;
+	}
+
+	const std::size_t firstLane = std::find(m_StepMask.begin(), m_StepMask.end(), -1) - m_StepMask.begin();
+
+	// The instruction must be the very same everywhere, parameters included
+	std::array<std::int64_t, MaxInstructionLength> words;
+	const std::int64_t opCodeWord = GetRow(instructionPointer)[firstLane];
+	if (opCodeWord < 0 || !IsValidOpCode(static_cast<int>(opCodeWord % 100)))
+	{
+		return false;
+	}
+
+	const OpCode opCode = static_cast<OpCode>(opCodeWord % 100);
+	const std::size_t parameterCount = GetParameterCount(opCode);
+	if (instructionPointer + static_cast<std::int64_t>(parameterCount) >= m_MemorySize)
+	{
+		return false;
+	}
+
+	for (std::size_t i = 0; i <= parameterCount; i++)
+	{
+		words[i] = GetRow(instructionPointer + i)[firstLane];
+		if (!m_Kernels->m_IsUniform(GetRow(instructionPointer + i), m_StepMask.data(), words[i], m_LaneCount))
+		{
+			return false;
+		}
+	}
+
+	std::array<BatchOperand, 3> operands;
+	std::array<std::int64_t, 3> addresses = { 0, 0, 0 };
+	for (std::size_t i = 0, modes = static_cast<std::size_t>(opCodeWord / 100); i < parameterCount; i++, modes /= 10)
+	{
+		const std::int64_t parameter = words[i + 1];
+		switch (static_cast<ParameterMode>(modes % 10))
+		{
+		case ParameterMode::POS:
+			if (parameter < 0 || parameter >= m_MemorySize)
+			{
+				return false;
+			}
+			operands[i].m_Row = GetRow(parameter);
+			addresses[i] = parameter;
+			break;
+		case ParameterMode::IMM:
+			operands[i].m_Immediate = parameter;
+			addresses[i] = -1;
+			break;
+		default:
+			// Relative bases are per instance
+			return false;
+		}
+	}
+
+	const auto getOutput = [&]() { return addresses[2] >= 0 ? GetRow(addresses[2]) : nullptr; };
+
+	bool overflowed = false;
+	switch (opCode)
+	{
+	case OpCode::ADD:
+	case OpCode::MUL:
+		if (!getOutput())
+		{
+			return false;
+		}
+		overflowed = (opCode == OpCode::ADD ? m_Kernels->m_Add : m_Kernels->m_Mul)(operands[0], operands[1], getOutput(), m_InstructionPointers.data(), m_StepMask.data(), m_LaneCount);
+		break;
+	case OpCode::LT_:
+	case OpCode::EQU:
+		if (!getOutput())
+		{
+			return false;
+		}
+		(opCode == OpCode::LT_ ? m_Kernels->m_LessThan : m_Kernels->m_Equals)(operands[0], operands[1], getOutput(), m_InstructionPointers.data(), m_StepMask.data(), m_LaneCount);
+		break;
+	case OpCode::JT_:
+		m_Kernels->m_JumpIfTrue(operands[0], operands[1], m_InstructionPointers.data(), m_StepMask.data(), m_LaneCount);
+		break;
+	case OpCode::JF_:
+		m_Kernels->m_JumpIfFalse(operands[0], operands[1], m_InstructionPointers.data(), m_StepMask.data(), m_LaneCount);
+		break;
+	case OpCode::HLT:
+		for (std::size_t lane = firstLane; lane < m_InstanceCount; lane++)
+		{
+			if (m_StepMask[lane])
+			{
+				Stop(lane, ExecutionStatus::Halted);
+			}
+		}
+		break;
+	default:
+		// I/O and relative base changes are per instance anyway
+		return false;
+	}
+
+	if (overflowed)
+	{
+		// Those are the ones which didn't move
+		for (std::size_t lane = firstLane; lane < m_InstanceCount; lane++)
+		{
+			if (m_StepMask[lane] && m_InstructionPointers[lane] == instructionPointer)
+			{
+				Stop(lane, ExecutionStatus::Overflowed);
+			}
+		}
+	}
+
+	return true;
+}
+
+void IntCodeBatch::ExecuteAlone(std::size_t lane)
+{
+	std::int64_t& instructionPointer = m_InstructionPointers[lane];
+	std::int64_t& relativeBase = m_RelativeBases[lane];
+
+	std::int64_t opCodeWord;
+	if (!ReadLane(lane, instructionPointer, opCodeWord) || opCodeWord < 0 || !IsValidOpCode(static_cast<int>(opCodeWord % 100)))
+	{
+		Stop(lane, ExecutionStatus::Halted, true);
+		return;
+	}
+
+	const OpCode opCode = static_cast<OpCode>(opCodeWord % 100);
+	const std::size_t parameterCount = GetParameterCount(opCode);
+
+	// Resolve every parameter up front: its address (if it has one) and its value
+	std::array<std::int64_t, 3> addresses = { -1, -1, -1 };
+	std::array<std::int64_t, 3> values = { 0, 0, 0 };
+	for (std::size_t i = 0, modes = static_cast<std::size_t>(opCodeWord / 100); i < parameterCount; i++, modes /= 10)
+	{
+		std::int64_t parameter = 0;
+		ReadLane(lane, instructionPointer + 1 + i, parameter);
+
+		switch (static_cast<ParameterMode>(modes % 10))
+		{
+		case ParameterMode::POS:
+			addresses[i] = parameter;
+			break;
+		case ParameterMode::REL:
+			if (!IntCodeInt64Policy::TryAdd(parameter, relativeBase, addresses[i]))
+			{
+				Stop(lane, ExecutionStatus::Overflowed);
+				return;
+			}
+			break;
+		case ParameterMode::IMM:
+			values[i] = parameter;
+			continue;
+		default:
+			Stop(lane, ExecutionStatus::Halted, true);
+			return;
+		}
+
+		if (addresses[i] < 0)
+		{
+			Stop(lane, ExecutionStatus::Halted, true);
+			return;
+		}
+
+		ReadLane(lane, addresses[i], values[i]);
+	}
+
+	const auto store = [&](std::size_t parameterIndex, std::int64_t value)
+	{
+		const std::int64_t address = addresses[parameterIndex];
+		if (address < 0)
+		{
+			Stop(lane, ExecutionStatus::Halted, true);
+			return false;
+		}
+		else if (address >= m_MemorySize)
+		{
+			Stop(lane, ExecutionStatus::Overflowed);
+			return false;
+		}
+
+		GetRow(address)[lane] = value;
+		return true;
+	};
+
+	std::int64_t result = 0;
+	switch (opCode)
+	{
+	case OpCode::ADD:
+	case OpCode::MUL:
+		if (!(opCode == OpCode::ADD ? IntCodeInt64Policy::TryAdd(values[0], values[1], result) : IntCodeInt64Policy::TryMul(values[0], values[1], result)))
+		{
+			Stop(lane, ExecutionStatus::Overflowed);
+			return;
+		}
+		break;
+	case OpCode::LT_:
+		result = values[0] < values[1] ? 1 : 0;
+		break;
+	case OpCode::EQU:
+		result = values[0] == values[1] ? 1 : 0;
+		break;
+	case OpCode::IN_:
+		if (m_ReadInputs[lane] == m_Inputs[lane].size())
+		{
+			Stop(lane, ExecutionStatus::AwaitingInput);
+			return;
+		}
+		result = m_Inputs[lane][m_ReadInputs[lane]];
+		break;
+	case OpCode::OU_:
+		m_Outputs[lane].push_back(values[0]);
+		instructionPointer += 2;
+		return;
+	case OpCode::JT_:
+	case OpCode::JF_:
+		instructionPointer = (values[0] != 0) == (opCode == OpCode::JT_) ? values[1] : instructionPointer + JumpLength;
+		return;
+	case OpCode::RBS:
+		if (!IntCodeInt64Policy::TryAdd(relativeBase, values[0], relativeBase))
+		{
+			Stop(lane, ExecutionStatus::Overflowed);
+			return;
+		}
+		instructionPointer += 2;
+		return;
+	case OpCode::HLT:
+	default:
+		Stop(lane, ExecutionStatus::Halted);
+		return;
+	}
+
+	// Only instructions writing memory get here, the output is always their last parameter
+	if (store(parameterCount - 1, result))
+	{
+		m_ReadInputs[lane] += opCode == OpCode::IN_ ? 1 : 0;
+		instructionPointer += 1 + parameterCount;
+	}
+}
+
+void IntCodeBatch::Stop(std::size_t lane, ExecutionStatus status, bool faulted)
+{
+	m_Statuses[lane] = status;
+	m_Faulted[lane] = faulted;
+	m_RunningMask[lane] = 0;
+}
+
+bool IntCodeBatch::ReadLane(std::size_t lane, std::int64_t address, std::int64_t& value) const
+{
+	if (address < 0)
+	{
+		return false;
+	}
+
+	// Nothing was ever written past the memory of the batch
+	value = address < m_MemorySize ? GetRow(address)[lane] : 0;
+	return true;
+}
@@ -0,0 +1,153 @@
+#include <IntcodeCompiledProgram.h>
+
+#include <algorithm>
+
+IntCodeCompiledProgram::IntCodeCompiledProgram(std::span<const std::int64_t> program, std::span<const bool> isCode, std::size_t memorySize)
+	: m_Memory(std::max(memorySize, program.size()), 0)
+	, m_InputChannel(std::make_shared<IntCodeChannel<std::int64_t>>())
+	, m_OutputChannel(std::make_shared<IntCodeChannel<std::int64_t>>())
+	, m_Program(program)
+	, m_IsCode(isCode)
+{
+	std::copy(program.begin(), program.end(), m_Memory.begin());
+}
+
+void IntCodeCompiledProgram::SetNounAndVerb(InitData initData)
+{
+	std::int64_t noun, verb;
+	if (!m_Interpreter && m_Memory.size() > 2 && IntCodeInt64Policy::TryFromBigInt(initData.noun, noun) && IntCodeInt64Policy::TryFromBigInt(initData.verb, verb))
+	{
+		// The translated code might have read either as an immediate value
+		const auto modifiesCode = [this](IntCodeAddress address, std::int64_t value) { return address < m_IsCode.size() && m_IsCode[address] && m_Memory[address] != value; };
+		m_HasModifiedCode |= modifiesCode(1, noun) || modifiesCode(2, verb);
+		m_Memory[1] = noun;
+		m_Memory[2] = verb;
+		return;
+	}
+
+	if (!m_Interpreter)
+	{
+		StartInterpreter();
+	}
+
+	m_Interpreter->SetNounAndVerb(initData);
+}
+
+void IntCodeCompiledProgram::Reset()
+{
+	std::fill(std::copy(m_Program.begin(), m_Program.end(), m_Memory.begin()), m_Memory.end(), 0);
+	m_InstructionPointer = 0;
+	m_RelativeBase = 0;
+	m_Status = ExecutionStatus::NotStarted;
+	m_HasModifiedCode = false;
+	m_Interpreter.reset();
+
+	m_InputChannel->Clear();
+	m_OutputChannel->Clear();
+}
+
+void IntCodeCompiledProgram::Execute()
+{
+	if (!m_Interpreter && !m_HasModifiedCode)
+	{
+		m_Status = ExecutionStatus::Running;
+
+		switch (RunNative())
+		{
+		case NativeExit::Halt:
+			m_Status = ExecutionStatus::Halted;
+			return;
+		case NativeExit::AwaitInput:
+			m_Status = ExecutionStatus::AwaitingInput;
+			return;
+		case NativeExit::Block:
+			m_Status = ExecutionStatus::Paused;
+			return;
+		case NativeExit::Interpret:
+		default:
+			break;
+		}
+	}
+
+	if (!m_Interpreter)
+	{
+		StartInterpreter();
+	}
+
+	m_Interpreter->Execute();
+}
+
+std::size_t IntCodeCompiledProgram::FeedInputs(std::span<const std::int64_t> inputs)
+{
+	return m_Interpreter ? m_Interpreter->FeedInputs(inputs) : m_InputChannel->Push(inputs);
+}
+
+std::size_t IntCodeCompiledProgram::FeedInputs(std::span<const IntCodeValue> inputs)
+{
+	std::size_t fed = 0;
+	for (std::int64_t input; !m_Interpreter && fed < inputs.size(); fed++)
+	{
+		if (!IntCodeInt64Policy::TryFromBigInt(inputs[fed], input))
+		{
+			// Too big for the translated code to even read it
+			StartInterpreter();
+			break;
+		}
+
+		if (!m_InputChannel->TryPush(input))
+		{
+			return fed;
+		}
+	}
+
+	return fed + (m_Interpreter ? m_Interpreter->FeedInputs(inputs.subspan(fed)) : 0);
+}
+
+std::size_t IntCodeCompiledProgram::DrainOutputs(std::span<std::int64_t> outputs)
+{
+	// Whatever the translated code output comes first
+	const std::size_t drained = m_OutputChannel->Pop(outputs);
+	return drained + (m_Interpreter ? m_Interpreter->DrainOutputs(outputs.subspan(drained)) : 0);
+}
+
+std::size_t IntCodeCompiledProgram::DrainOutputs(std::span<IntCodeValue> outputs)
+{
+	std::size_t drained = 0;
+	for (std::int64_t output; drained < outputs.size() && m_OutputChannel->TryPop(output); drained++)
+	{
+		outputs[drained] = output;
+	}
+
+	return drained + (m_Interpreter ? m_Interpreter->DrainOutputs(outputs.subspan(drained)) : 0);
+}
+
+std::size_t IntCodeCompiledProgram::GetOutputCount() const
+{
+	return m_OutputChannel->GetSize() + (m_Interpreter ? m_Interpreter->GetOutputCount() : 0);
+}
+
+IntCodeValue IntCodeCompiledProgram::GetValueAt(IntCodeAddress address) const
+{
+	if (m_Interpreter)
+	{
+		return m_Interpreter->GetValueAt(address);
+	}
+
+	return address < m_Memory.size() ? m_Memory[address] : 0;
+}
+
+void IntCodeCompiledProgram::StartInterpreter()
+{
+	// Nothing beyond the last non zero value is worth copying
+	const auto lastValue = std::find_if(m_Memory.rbegin(), m_Memory.rend(), [](std::int64_t value) { return value != 0; });
+	const std::size_t programSize = std::max<std::size_t>(m_Memory.rend() - lastValue, m_Program.size());
+
+	IntCodeProgram program(m_Memory.begin(), m_Memory.begin() + programSize);
+	m_Interpreter.emplace(IntCodeProgramImage::Create(std::move(program)));
+	m_Interpreter->SetExecutionState(static_cast<IntCodeAddress>(m_InstructionPointer), m_RelativeBase);
+
+	for (std::int64_t input; m_InputChannel->TryPop(input);)
+	{
+		m_Interpreter->FeedInputs(std::span(&input, 1));
+	}
+}
@@ -0,0 +1,428 @@
+#include <IntcodeDisassembler.h>
+
+#include <algorithm>
+
+IntCodeDisassembler::IntCodeDisassembler(const IntCodeProgram& program)
+	: m_Program(program)
+	, m_CellKinds(program.size(), CellKind::Unknown)
+{
+	Discover(0, false);
+
+	// Return addresses are pushed as immediate values: keep looking as long as new code shows up
+	for (bool hasFoundCode = true; hasFoundCode;)
+	{
+		std::set<IntCodeAddress> candidates;
+		for (const auto& [address, instruction] : m_Instructions)
+		{
+			for (std::size_t i = 0; i < instruction.m_Length - 1; i++)
+			{
+				IntCodeAddress candidate;
+				if (instruction.m_Modes[i] == ParameterMode::IMM && TryGetProgramAddress(instruction.m_Parameters[i], candidate) && m_Instructions.count(candidate) == 0)
+				{
+					candidates.insert(candidate);
+				}
+			}
+		}
+
+		hasFoundCode = false;
+		for (IntCodeAddress candidate : candidates)
+		{
+			hasFoundCode |= Discover(candidate, true);
+		}
+	}
+
+	ClassifyCells();
+	BuildBasicBlocks();
+}
+
+const IntCodeDisassembler::Instruction* IntCodeDisassembler::FindInstruction(IntCodeAddress address) const
+{
+	const auto it = m_Instructions.find(address);
+	return it != m_Instructions.end() ? &it->second : nullptr;
+}
+
+const IntCodeDisassembler::BasicBlock* IntCodeDisassembler::FindBasicBlock(IntCodeAddress address) const
+{
+	auto it = m_BasicBlocks.upper_bound(address);
+	if (it == m_BasicBlocks.begin())
+	{
+		return nullptr;
+	}
+
+	--it;
+	return address < it->second.m_End ? &it->second : nullptr;
+}
+
+IntCodeDisassembler::CellKind IntCodeDisassembler::GetCellKind(IntCodeAddress address) const
+{
+	return address < m_CellKinds.size() ? m_CellKinds[address] : CellKind::Unknown;
+}
+
+bool IntCodeDisassembler::IsCodeStatic() const
+{
+	if (!m_SelfModifyingWrites.empty() || !m_RelativeWrites.empty())
+	{
+		return false;
+	}
+
+	return std::none_of(m_BasicBlocks.begin(), m_BasicBlocks.end(), [](const auto& block) { return block.second.m_HasUnknownSuccessor; });
+}
+
+void IntCodeDisassembler::WriteInstruction(std::ostream& output, const Instruction& instruction)
+{
+	output << GetOpCodeName(instruction.m_OpCode);
+	for (std::size_t i = 0; i < instruction.m_Length - 1; i++)
+	{
+		const IntCodeValue& parameter = instruction.m_Parameters[i];
+		output << (i == 0 ? " " : ", ");
+		switch (instruction.m_Modes[i])
+		{
+		case ParameterMode::IMM: output << parameter; break;
+		case ParameterMode::REL: output << "[rb" << (parameter < 0 ? "" : "+") << parameter << "]"; break;
+		case ParameterMode::POS:
+		default:
+			output << "[" << parameter << "]";
+			break;
+		}
+	}
+}
+
+void IntCodeDisassembler::WriteListing(std::ostream& output) const
+{
+	const auto writeAddresses = [&output](const char* prefix, const std::vector<IntCodeAddress>& addresses)
+	{
+		for (std::size_t i = 0; i < addresses.size(); i++)
+		{
+			output << (i == 0 ? prefix : ", ") << addresses[i];
+		}
+	};
+
+	for (IntCodeAddress address = 0; address < m_Program.size();)
+	{
+		const auto blockIt = m_BasicBlocks.find(address);
+		if (blockIt != m_BasicBlocks.end())
+		{
+			const BasicBlock& block = blockIt->second;
+			output << "\n; block " << address;
+			writeAddresses(", from ", block.m_Predecessors);
+			writeAddresses(", to ", block.m_Successors);
+			output << (block.m_HasUnknownSuccessor ? (block.m_Successors.empty() ? ", to ?" : ", ?") : "") << "\n";
+		}
+
+		const Instruction* instruction = FindInstruction(address);
+		if (instruction == nullptr)
+		{
+			output << address << ":\t" << m_Program[address] << (m_CellKinds[address] == CellKind::Data ? "\t; data" : "") << "\n";
+			address++;
+			continue;
+		}
+
+		output << address << ":\t";
+		WriteInstruction(output, *instruction);
+		if (std::binary_search(m_SelfModifyingWrites.begin(), m_SelfModifyingWrites.end(), address))
+		{
+			output << "\t; writes code";
+		}
+		else if (std::binary_search(m_IndirectJumps.begin(), m_IndirectJumps.end(), address))
+		{
+			output << "\t; computed jump";
+		}
+		output << "\n";
+
+		address += instruction->m_Length;
+	}
+}
+
+bool IntCodeDisassembler::TryDecode(IntCodeAddress address, Instruction& instruction) const
+{
+	std::int64_t value;
+	if (address >= m_Program.size() || !IntCodeInt64Policy::TryFromBigInt(m_Program[address], value) || value < 0 || !IsValidOpCode(static_cast<int>(value % 100)))
+	{
+		return false;
+	}
+
+	instruction.m_OpCode = static_cast<OpCode>(value % 100);
+	instruction.m_Length = GetParameterCount(instruction.m_OpCode) + 1;
+	if (address + instruction.m_Length > m_Program.size())
+	{
+		return false;
+	}
+
+	std::int64_t modes = value / 100;
+	for (std::size_t i = 0; i < instruction.m_Length - 1; i++, modes /= 10)
+	{
+		if (modes % 10 > static_cast<std::int64_t>(ParameterMode::REL))
+		{
+			return false;
+		}
+
+		instruction.m_Modes[i] = static_cast<ParameterMode>(modes % 10);
+		instruction.m_Parameters[i] = m_Program[address + 1 + i];
+	}
+
+	// Leftover modes and immediate stores are left to whatever the interpreter makes of them
+	const std::size_t storedParameter = GetStoredParameter(instruction.m_OpCode);
+	return modes == 0 && (storedParameter >= instruction.m_Length - 1 || instruction.m_Modes[storedParameter] != ParameterMode::IMM);
+}
+
+bool IntCodeDisassembler::Discover(IntCodeAddress root, bool isTentative)
+{
+	std::map<IntCodeAddress, Instruction> found;
+	std::set<IntCodeAddress> foundCells;
+
+	std::vector<IntCodeAddress> pending = { root };
+	while (!pending.empty())
+	{
+		const IntCodeAddress address = pending.back();
+		pending.pop_back();
+
+		if (m_Instructions.count(address) > 0 || found.count(address) > 0)
+		{
+			continue;
+		}
+
+		Instruction instruction;
+		if (!TryDecode(address, instruction))
+		{
+			if (isTentative)
+			{
+				return false;
+			}
+
+			continue;
+		}
+
+		const std::size_t storedParameter = GetStoredParameter(instruction.m_OpCode);
+		if (isTentative)
+		{
+			// Only take data for code if it really looks like code
+			for (IntCodeAddress cell = address; cell < address + instruction.m_Length; cell++)
+			{
+				if (IsCode(cell) || m_DataAddresses.count(cell) > 0 || foundCells.count(cell) > 0)
+				{
+					return false;
+				}
+			}
+
+			IntCodeAddress target;
+			if (storedParameter < instruction.m_Length - 1 && instruction.m_Modes[storedParameter] == ParameterMode::POS
+				&& TryGetProgramAddress(instruction.m_Parameters[storedParameter], target) && (IsCode(target) || foundCells.count(target) > 0))
+			{
+				return false;
+			}
+
+			for (IntCodeAddress cell = address; cell < address + instruction.m_Length; cell++)
+			{
+				foundCells.insert(cell);
+			}
+		}
+
+		found[address] = instruction;
+
+		if (instruction.m_OpCode == OpCode::HLT)
+		{
+			continue;
+		}
+
+		pending.push_back(address + instruction.m_Length);
+
+		const bool isJump = instruction.m_OpCode == OpCode::JT_ || instruction.m_OpCode == OpCode::JF_;
+		if (isJump && instruction.m_Modes[1] == ParameterMode::IMM && instruction.m_Parameters[1] >= 0)
+		{
+			IntCodeAddress target;
+			if (TryGetProgramAddress(instruction.m_Parameters[1], target))
+			{
+				pending.push_back(target);
+			}
+			else if (isTentative)
+			{
+				return false;
+			}
+		}
+	}
+
+	for (const auto& [address, instruction] : found)
+	{
+		std::fill(m_CellKinds.begin() + address, m_CellKinds.begin() + address + instruction.m_Length, CellKind::Code);
+
+		const std::size_t storedParameter = GetStoredParameter(instruction.m_OpCode);
+		IntCodeAddress target;
+		if (storedParameter < instruction.m_Length - 1 && instruction.m_Modes[storedParameter] == ParameterMode::POS && TryGetProgramAddress(instruction.m_Parameters[storedParameter], target))
+		{
+			m_DataAddresses.insert(target);
+		}
+
+		m_Instructions.insert({ address, instruction });
+	}
+
+	return !found.empty();
+}
+
+void IntCodeDisassembler::ClassifyCells()
+{
+	for (const auto& [address, instruction] : m_Instructions)
+	{
+		const std::size_t storedParameter = GetStoredParameter(instruction.m_OpCode);
+		bool isWritingCode = false;
+
+		for (std::size_t i = 0; i < instruction.m_Length - 1; i++)
+		{
+			IntCodeAddress cell;
+			if (instruction.m_Modes[i] != ParameterMode::POS || !TryGetProgramAddress(instruction.m_Parameters[i], cell))
+			{
+				continue;
+			}
+
+			if (i == storedParameter && IsCode(cell))
+			{
+				m_CellKinds[cell] = CellKind::ModifiedCode;
+				isWritingCode = true;
+			}
+			else if (!IsCode(cell))
+			{
+				m_CellKinds[cell] = CellKind::Data;
+			}
+		}
+
+		if (isWritingCode)
+		{
+			m_SelfModifyingWrites.push_back(address);
+		}
+
+		if (storedParameter < instruction.m_Length - 1 && instruction.m_Modes[storedParameter] == ParameterMode::REL)
+		{
+			m_RelativeWrites.push_back(address);
+		}
+
+		switch (instruction.m_OpCode)
+		{
+		case OpCode::IN_:
+			m_InputSites.push_back(address);
+			break;
+		case OpCode::OU_:
+			m_OutputSites.push_back(address);
+			break;
+		case OpCode::JT_:
+		case OpCode::JF_:
+			if (instruction.m_Modes[1] != ParameterMode::IMM)
+			{
+				m_IndirectJumps.push_back(address);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+void IntCodeDisassembler::BuildBasicBlocks()
+{
+	const auto isJump = [](OpCode opCode) { return opCode == OpCode::JT_ || opCode == OpCode::JF_; };
+
+	// Blocks start wherever control can arrive other than by falling through the previous instruction
+	std::set<IntCodeAddress> leaders;
+	IntCodeAddress previousEnd = 0;
+	bool canFallThrough = false;
+	for (const auto& [address, instruction] : m_Instructions)
+	{
+		if (!canFallThrough || previousEnd != address)
+		{
+			leaders.insert(address);
+		}
+
+		previousEnd = address + instruction.m_Length;
+		canFallThrough = !isJump(instruction.m_OpCode) && instruction.m_OpCode != OpCode::HLT;
+
+		IntCodeAddress target;
+		if (isJump(instruction.m_OpCode) && instruction.m_Modes[1] == ParameterMode::IMM && TryGetProgramAddress(instruction.m_Parameters[1], target) && m_Instructions.count(target) > 0)
+		{
+			leaders.insert(target);
+		}
+	}
+
+	for (IntCodeAddress leader : leaders)
+	{
+		BasicBlock& block = m_BasicBlocks[leader];
+		block.m_Begin = leader;
+
+		const auto addSuccessor = [&](IntCodeAddress successor)
+		{
+			if (m_Instructions.count(successor) == 0)
+			{
+				block.m_HasUnknownSuccessor = true;
+			}
+			else if (std::find(block.m_Successors.begin(), block.m_Successors.end(), successor) == block.m_Successors.end())
+			{
+				block.m_Successors.push_back(successor);
+			}
+		};
+
+		for (IntCodeAddress address = leader;;)
+		{
+			const Instruction& instruction = m_Instructions.at(address);
+			const IntCodeAddress next = address + instruction.m_Length;
+			block.m_Instructions.push_back(address);
+			block.m_End = next;
+
+			if (instruction.m_OpCode == OpCode::HLT)
+			{
+				break;
+			}
+
+			if (isJump(instruction.m_OpCode))
+			{
+				const bool isJumpTrue = instruction.m_OpCode == OpCode::JT_;
+				const bool isConstant = instruction.m_Modes[0] == ParameterMode::IMM;
+				const bool isAlwaysTaken = isConstant && (instruction.m_Parameters[0] != 0) == isJumpTrue;
+				const bool isNeverTaken = isConstant && !isAlwaysTaken;
+
+				if (!isNeverTaken)
+				{
+					IntCodeAddress target;
+					if (instruction.m_Modes[1] == ParameterMode::IMM && TryGetProgramAddress(instruction.m_Parameters[1], target))
+					{
+						addSuccessor(target);
+					}
+					else
+					{
+						block.m_HasUnknownSuccessor = true;
+					}
+				}
+
+				if (!isAlwaysTaken)
+				{
+					addSuccessor(next);
+				}
+
+				break;
+			}
+
+			if (m_Instructions.count(next) == 0 || leaders.count(next) > 0)
+			{
+				addSuccessor(next);
+				break;
+			}
+
+			address = next;
+		}
+	}
+
+	for (const auto& [address, block] : m_BasicBlocks)
+	{
+		for (IntCodeAddress successor : block.m_Successors)
+		{
+			m_BasicBlocks.at(successor).m_Predecessors.push_back(address);
+		}
+	}
+}
+
+bool IntCodeDisassembler::TryGetProgramAddress(const IntCodeValue& parameter, IntCodeAddress& address) const
+{
+	if (parameter < 0 || parameter >= m_Program.size())
+	{
+		return false;
+	}
+
+	address = parameter.convert_to<IntCodeAddress>();
+	return true;
+}
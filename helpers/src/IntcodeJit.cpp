@@ -0,0 +1,879 @@
+#include <IntcodeJit.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <map>
+
+#if INTCODE_HAS_JIT
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// Where compiled code finds everything it needs, rbx points to it while it runs
+	struct NativeContext
+	{
+		const std::int64_t* const*	m_ReadablePages;
+		std::int64_t* const*		m_WritablePages;
+		std::uint64_t				m_PageCount;
+		std::int64_t				m_RelativeBase;
+
+		// Writes below this one are reported through m_HasWrittenWatched
+		std::uint64_t				m_WatchedEnd;
+		std::uint8_t				m_HasWrittenWatched;
+	};
+
+	// Returns the address of the instruction to go on with
+	using NativeFunction = std::int64_t (*)(NativeContext* context, const void* entry);
+
+	// Read by every missing page
+	const IntCodeMemory<IntCodeInt64Policy>::Page s_ZeroPage = {};
+
+	constexpr std::uint32_t MaxStalledRuns = 8;
+
+	// How far from its entry a region can go, in addresses
+	constexpr IntCodeAddress MaxRegionSpan = 1024;
+
+	/*******************************************************************************************
+
+	 Just enough of an x86-64 assembler for IntCode: 64 bit moves, arithmetic and compares
+	 between registers, [base + displacement] and [base + index * scale] memory operands,
+	 and 32 bit relative jumps to labels.
+
+	*******************************************************************************************/
+
+	class Assembler
+	{
+	public:
+		enum Register : std::uint8_t
+		{
+			RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+			R8, R9, R10, R11, R12, R13, R14, R15
+		};
+
+		enum Condition : std::uint8_t
+		{
+			Overflow = 0x0,
+			Below = 0x2,
+			AboveOrEqual = 0x3,
+			Equal = 0x4,
+			NotEqual = 0x5,
+			Less = 0xC
+		};
+
+		using Label = std::size_t;
+
+		Label NewLabel()
+		{
+			m_Labels.push_back(Unbound);
+			return m_Labels.size() - 1;
+		}
+
+		void Bind(Label label) { m_Labels[label] = m_Code.size(); }
+		bool IsBound(Label label) const { return m_Labels[label] != Unbound; }
+
+		void MovImmediate(Register destination, std::int64_t value)
+		{
+			if (value >= INT32_MIN && value <= INT32_MAX)
+			{
+				Rex(true, 0, 0, destination);
+				Emit(0xC7);
+				ModRM(3, 0, destination);
+				Emit32(static_cast<std::int32_t>(value));
+			}
+			else
+			{
+				Rex(true, 0, 0, destination);
+				Emit(0xB8 + (destination & 7));
+				Emit64(value);
+			}
+		}
+
+		void Mov(Register destination, Register source) { RegisterOperation(0x89, source, destination); }
+		void Add(Register destination, Register source) { RegisterOperation(0x01, source, destination); }
+		void Cmp(Register lhs, Register rhs) { RegisterOperation(0x39, rhs, lhs); }
+		void Test(Register lhs, Register rhs) { RegisterOperation(0x85, rhs, lhs); }
+
+		void Imul(Register destination, Register source)
+		{
+			Rex(true, destination, 0, source);
+			Emit(0x0F);
+			Emit(0xAF);
+			ModRM(3, destination, source);
+		}
+
+		void AddImmediate(Register destination, std::int32_t value) { ImmediateOperation(0, destination, value); }
+		void AndImmediate(Register destination, std::int32_t value) { ImmediateOperation(4, destination, value); }
+		void CmpImmediate(Register lhs, std::int32_t value) { ImmediateOperation(7, lhs, value); }
+
+		void ShrImmediate(Register destination, std::uint8_t shift)
+		{
+			Rex(true, 0, 0, destination);
+			Emit(0xC1);
+			ModRM(3, 5, destination);
+			Emit(shift);
+		}
+
+		// mov destination, [base + displacement]
+		void Load(Register destination, Register base, std::int32_t displacement) { MemoryOperation(0x8B, destination, base, displacement); }
+
+		// mov [base + displacement], source
+		void Store(Register base, std::int32_t displacement, Register source) { MemoryOperation(0x89, source, base, displacement); }
+
+		// cmp lhs, [base + displacement]
+		void CmpMemory(Register lhs, Register base, std::int32_t displacement) { MemoryOperation(0x3B, lhs, base, displacement); }
+
+		// mov byte [base + displacement], value
+		void StoreByteImmediate(Register base, std::int32_t displacement, std::uint8_t value)
+		{
+			if (base >= R8)
+			{
+				Rex(false, 0, 0, base);
+			}
+			Emit(0xC6);
+			MemoryOperand(0, base, displacement);
+			Emit(value);
+		}
+
+		// mov destination, [base + index * 8]
+		void LoadIndexed(Register destination, Register base, Register index) { IndexedOperation(0x8B, destination, base, index, 3); }
+
+		// mov [base + index * 8], source
+		void StoreIndexed(Register base, Register index, Register source) { IndexedOperation(0x89, source, base, index, 3); }
+
+		// movsxd destination, dword [base + index * 4]
+		void LoadIndexedInt32(Register destination, Register base, Register index) { IndexedOperation(0x63, destination, base, index, 2); }
+
+		// Only for RAX, RCX, RDX and RBX, which need no REX prefix as bytes
+		void SetCondition(Condition condition, Register destination)
+		{
+			Emit(0x0F);
+			Emit(0x90 + condition);
+			ModRM(3, 0, destination);
+		}
+
+		// movzx destination (32 bits, which clears the upper half), source (8 bits)
+		void MovZeroExtendByte(Register destination, Register source)
+		{
+			Emit(0x0F);
+			Emit(0xB6);
+			ModRM(3, destination, source);
+		}
+
+		void Jump(Label label)
+		{
+			Emit(0xE9);
+			Relative32(label);
+		}
+
+		void JumpIf(Condition condition, Label label)
+		{
+			Emit(0x0F);
+			Emit(0x80 + condition);
+			Relative32(label);
+		}
+
+		void JumpTo(Register target)
+		{
+			if (target >= R8)
+			{
+				Rex(false, 0, 0, target);
+			}
+			Emit(0xFF);
+			ModRM(3, 4, target);
+		}
+
+		// lea destination, [rip + label]
+		void LoadLabelAddress(Register destination, Label label)
+		{
+			Rex(true, destination, 0, RBP);
+			Emit(0x8D);
+			ModRM(0, destination, RBP);
+			Relative32(label);
+		}
+
+		void Push(Register source)
+		{
+			if (source >= R8)
+			{
+				Rex(false, 0, 0, source);
+			}
+			Emit(0x50 + (source & 7));
+		}
+
+		void Pop(Register destination)
+		{
+			if (destination >= R8)
+			{
+				Rex(false, 0, 0, destination);
+			}
+			Emit(0x58 + (destination & 7));
+		}
+
+		void Ret() { Emit(0xC3); }
+
+		// A table entry: where target is, relative to base
+		void EmitLabelOffset(Label target, Label base)
+		{
+			m_Fixups.push_back({ m_Code.size(), target, base });
+			Emit32(0);
+		}
+
+		inline std::size_t GetLabelOffset(Label label) const { return m_Labels[label]; }
+
+		// Resolves every label reference, all of them must be bound by now
+		std::vector<std::uint8_t> Finish()
+		{
+			for (const Fixup& fixup : m_Fixups)
+			{
+				const std::size_t origin = fixup.m_Base == Unbound ? fixup.m_Position + 4 : m_Labels[fixup.m_Base];
+				const std::int32_t offset = static_cast<std::int32_t>(static_cast<std::int64_t>(m_Labels[fixup.m_Target]) - static_cast<std::int64_t>(origin));
+				std::memcpy(&m_Code[fixup.m_Position], &offset, sizeof(offset));
+			}
+
+			return std::move(m_Code);
+		}
+
+	private:
+		static constexpr std::size_t Unbound = ~std::size_t(0);
+
+		struct Fixup
+		{
+			std::size_t	m_Position;
+			Label		m_Target;
+
+			// Relative to the end of the instruction when unbound
+			std::size_t	m_Base;
+		};
+
+		void Emit(std::uint8_t byte) { m_Code.push_back(byte); }
+
+		void Emit32(std::int32_t value)
+		{
+			const std::size_t position = m_Code.size();
+			m_Code.resize(position + sizeof(value));
+			std::memcpy(&m_Code[position], &value, sizeof(value));
+		}
+
+		void Emit64(std::int64_t value)
+		{
+			const std::size_t position = m_Code.size();
+			m_Code.resize(position + sizeof(value));
+			std::memcpy(&m_Code[position], &value, sizeof(value));
+		}
+
+		void Relative32(Label label)
+		{
+			m_Fixups.push_back({ m_Code.size(), label, Unbound });
+			Emit32(0);
+		}
+
+		void Rex(bool isWide, std::uint8_t reg, std::uint8_t index, std::uint8_t base)
+		{
+			Emit(0x40 | (isWide ? 0x08 : 0) | ((reg >> 3) << 2) | ((index >> 3) << 1) | (base >> 3));
+		}
+
+		void ModRM(std::uint8_t mode, std::uint8_t reg, std::uint8_t rm)
+		{
+			Emit(static_cast<std::uint8_t>((mode << 6) | ((reg & 7) << 3) | (rm & 7)));
+		}
+
+		void RegisterOperation(std::uint8_t opCode, Register reg, Register rm)
+		{
+			Rex(true, reg, 0, rm);
+			Emit(opCode);
+			ModRM(3, reg, rm);
+		}
+
+		void ImmediateOperation(std::uint8_t extension, Register rm, std::int32_t value)
+		{
+			Rex(true, 0, 0, rm);
+			Emit(0x81);
+			ModRM(3, extension, rm);
+			Emit32(value);
+		}
+
+		// Always with a 32 bit displacement, and a SIB byte when the base needs one
+		void MemoryOperand(std::uint8_t reg, Register base, std::int32_t displacement)
+		{
+			ModRM(2, reg, base);
+			if ((base & 7) == RSP)
+			{
+				Emit(0x24);
+			}
+			Emit32(displacement);
+		}
+
+		void MemoryOperation(std::uint8_t opCode, Register reg, Register base, std::int32_t displacement)
+		{
+			Rex(true, reg, 0, base);
+			Emit(opCode);
+			MemoryOperand(reg, base, displacement);
+		}
+
+		void IndexedOperation(std::uint8_t opCode, Register reg, Register base, Register index, std::uint8_t scale)
+		{
+			Rex(true, reg, index, base);
+			Emit(opCode);
+			ModRM(2, reg, RSP);
+			Emit(static_cast<std::uint8_t>((scale << 6) | ((index & 7) << 3) | (base & 7)));
+			Emit32(0);
+		}
+
+		std::vector<std::uint8_t>	m_Code;
+		std::vector<std::size_t>	m_Labels;
+		std::vector<Fixup>			m_Fixups;
+	};
+
+	using Register = Assembler::Register;
+
+	// Registers holding the state of the IntCode program while compiled code runs
+	constexpr Register ContextRegister = Assembler::RBX;
+	constexpr Register ReadablePagesRegister = Assembler::R12;
+	constexpr Register WritablePagesRegister = Assembler::R13;
+	constexpr Register RelativeBaseRegister = Assembler::R14;
+	constexpr Register PageCountRegister = Assembler::R15;
+
+	constexpr Register CalleeSavedRegisters[] = { Assembler::RBX, Assembler::RBP, Assembler::R12, Assembler::R13, Assembler::R14, Assembler::R15 };
+
+	constexpr std::uint8_t PageBits = static_cast<std::uint8_t>(IntCodeJit::Memory::PageBits);
+	constexpr std::int32_t PageMask = static_cast<std::int32_t>(IntCodeJit::Memory::PageMask);
+}
+
+/***********************************************************************************************
+
+ Machine code in memory mapped executable (and never writable at the same time).
+
+************************************************************************************************/
+
+struct IntCodeJit::Region
+{
+	Region() = default;
+	Region(const Region& other) = delete;
+	Region& operator=(const Region& other) = delete;
+
+	~Region()
+	{
+#if INTCODE_HAS_JIT
+		if (m_Code)
+		{
+			munmap(m_Code, m_CodeSize);
+		}
+#endif
+	}
+
+	// The instructions the region was compiled from, with their parameters
+	IntCodeAddress							m_FirstAddress = 0;
+	std::vector<std::int64_t>				m_Program;
+
+	// Offset of each instruction in the machine code
+	std::map<IntCodeAddress, std::size_t>	m_Entries;
+
+	void*									m_Code = nullptr;
+	std::size_t								m_CodeSize = 0;
+
+	inline IntCodeAddress GetEndAddress() const { return m_FirstAddress + m_Program.size(); }
+};
+
+namespace
+{
+	// Compiles the instructions of one region, see IntCodeJit::TryCompile
+	class RegionCompiler : public IntCodeDefinitions
+	{
+	public:
+		struct Instruction
+		{
+			OpCode							m_OpCode;
+			std::size_t						m_Length;
+			std::array<ParameterMode, 3>	m_Modes;
+			std::array<std::int64_t, 3>		m_Parameters;
+		};
+
+		RegionCompiler(const std::map<IntCodeAddress, Instruction>& instructions, IntCodeAddress firstAddress, IntCodeAddress endAddress)
+			: m_Instructions(instructions)
+			, m_FirstAddress(firstAddress)
+			, m_EndAddress(endAddress)
+		{
+		}
+
+		std::vector<std::uint8_t> Compile(std::map<IntCodeAddress, std::size_t>& entries)
+		{
+			m_Epilogue = m_Assembler.NewLabel();
+			m_JumpTable = m_Assembler.NewLabel();
+			for (const auto& [address, instruction] : m_Instructions)
+			{
+				m_InstructionLabels[address] = m_Assembler.NewLabel();
+			}
+
+			// Prologue: (context, entry) as in the System V calling convention
+			for (Register reg : CalleeSavedRegisters)
+			{
+				m_Assembler.Push(reg);
+			}
+			m_Assembler.Mov(ContextRegister, Assembler::RDI);
+			m_Assembler.Load(ReadablePagesRegister, ContextRegister, offsetof(NativeContext, m_ReadablePages));
+			m_Assembler.Load(WritablePagesRegister, ContextRegister, offsetof(NativeContext, m_WritablePages));
+			m_Assembler.Load(PageCountRegister, ContextRegister, offsetof(NativeContext, m_PageCount));
+			m_Assembler.Load(RelativeBaseRegister, ContextRegister, offsetof(NativeContext, m_RelativeBase));
+			m_Assembler.JumpTo(Assembler::RSI);
+
+			for (auto it = m_Instructions.begin(); it != m_Instructions.end(); ++it)
+			{
+				const auto& [address, instruction] = *it;
+				m_Assembler.Bind(m_InstructionLabels[address]);
+				CompileInstruction(address, instruction);
+
+				const IntCodeAddress next = address + instruction.m_Length;
+				const auto nextIt = std::next(it);
+				if (nextIt == m_Instructions.end() || nextIt->first != next)
+				{
+					m_Assembler.Jump(GetTarget(static_cast<std::int64_t>(next)));
+				}
+			}
+
+			// Leaving, with the address to go on with in rax
+			for (const auto& [address, label] : m_Exits)
+			{
+				m_Assembler.Bind(label);
+				m_Assembler.MovImmediate(Assembler::RAX, address);
+				m_Assembler.Jump(m_Epilogue);
+			}
+
+			m_Assembler.Bind(m_Epilogue);
+			m_Assembler.Store(ContextRegister, offsetof(NativeContext, m_RelativeBase), RelativeBaseRegister);
+			for (auto it = std::rbegin(CalleeSavedRegisters); it != std::rend(CalleeSavedRegisters); ++it)
+			{
+				m_Assembler.Pop(*it);
+			}
+			m_Assembler.Ret();
+
+			// Computed jumps: one entry per address of the region, leaving for non-instructions
+			m_Assembler.Bind(m_JumpTable);
+			for (IntCodeAddress address = m_FirstAddress; address < m_EndAddress; address++)
+			{
+				const auto it = m_InstructionLabels.find(address);
+				m_Assembler.EmitLabelOffset(it != m_InstructionLabels.end() ? it->second : m_Epilogue, m_JumpTable);
+			}
+
+			for (const auto& [address, label] : m_InstructionLabels)
+			{
+				entries[address] = m_Assembler.GetLabelOffset(label);
+			}
+
+			return m_Assembler.Finish();
+		}
+
+	private:
+		// Jumps within the region stay in it, others leave
+		Assembler::Label GetTarget(std::int64_t address)
+		{
+			const auto it = address >= 0 ? m_InstructionLabels.find(static_cast<IntCodeAddress>(address)) : m_InstructionLabels.end();
+			return it != m_InstructionLabels.end() ? it->second : GetExit(address);
+		}
+
+		Assembler::Label GetExit(std::int64_t address)
+		{
+			const auto it = m_Exits.find(address);
+			return it != m_Exits.end() ? it->second : m_Exits.emplace(address, m_Assembler.NewLabel()).first->second;
+		}
+
+		void AddConstant(Register destination, std::int64_t value, Assembler::Label overflow)
+		{
+			if (value >= INT32_MIN && value <= INT32_MAX)
+			{
+				m_Assembler.AddImmediate(destination, static_cast<std::int32_t>(value));
+			}
+			else
+			{
+				m_Assembler.MovImmediate(Assembler::RSI, value);
+				m_Assembler.Add(destination, Assembler::RSI);
+			}
+			m_Assembler.JumpIf(Assembler::Overflow, overflow);
+		}
+
+		void ComputeAddress(Register destination, const Instruction& instruction, std::size_t index, Assembler::Label deoptimize)
+		{
+			if (instruction.m_Modes[index] == ParameterMode::REL)
+			{
+				m_Assembler.Mov(destination, RelativeBaseRegister);
+				AddConstant(destination, instruction.m_Parameters[index], deoptimize);
+			}
+			else
+			{
+				m_Assembler.MovImmediate(destination, instruction.m_Parameters[index]);
+			}
+		}
+
+		void LoadParameter(Register destination, const Instruction& instruction, std::size_t index, Assembler::Label deoptimize)
+		{
+			if (instruction.m_Modes[index] == ParameterMode::IMM)
+			{
+				m_Assembler.MovImmediate(destination, instruction.m_Parameters[index]);
+				return;
+			}
+
+			ComputeAddress(destination, instruction, index, deoptimize);
+
+			// Negative addresses end up past any page
+			m_Assembler.Mov(Assembler::RSI, destination);
+			m_Assembler.ShrImmediate(Assembler::RSI, PageBits);
+			m_Assembler.Cmp(Assembler::RSI, PageCountRegister);
+			m_Assembler.JumpIf(Assembler::AboveOrEqual, deoptimize);
+			m_Assembler.LoadIndexed(Assembler::RSI, ReadablePagesRegister, Assembler::RSI);
+			m_Assembler.AndImmediate(destination, PageMask);
+			m_Assembler.LoadIndexed(destination, Assembler::RSI, destination);
+		}
+
+		// Stores rax at the address in rdx
+		void StoreResult(Assembler::Label deoptimize)
+		{
+			// Over our own code, which would make it stale
+			Assembler::Label isNotCode = m_Assembler.NewLabel();
+			m_Assembler.CmpImmediate(Assembler::RDX, static_cast<std::int32_t>(m_FirstAddress));
+			m_Assembler.JumpIf(Assembler::Below, isNotCode);
+			m_Assembler.CmpImmediate(Assembler::RDX, static_cast<std::int32_t>(m_EndAddress));
+			m_Assembler.JumpIf(Assembler::Below, deoptimize);
+			m_Assembler.Bind(isNotCode);
+
+			m_Assembler.Mov(Assembler::RSI, Assembler::RDX);
+			m_Assembler.ShrImmediate(Assembler::RSI, PageBits);
+			m_Assembler.Cmp(Assembler::RSI, PageCountRegister);
+			m_Assembler.JumpIf(Assembler::AboveOrEqual, deoptimize);
+			m_Assembler.LoadIndexed(Assembler::RSI, WritablePagesRegister, Assembler::RSI);
+			m_Assembler.Test(Assembler::RSI, Assembler::RSI);
+			m_Assembler.JumpIf(Assembler::Equal, deoptimize);
+
+			// Somebody else's code (or the interpreter's) might need to know
+			Assembler::Label isNotWatched = m_Assembler.NewLabel();
+			m_Assembler.CmpMemory(Assembler::RDX, ContextRegister, offsetof(NativeContext, m_WatchedEnd));
+			m_Assembler.JumpIf(Assembler::AboveOrEqual, isNotWatched);
+			m_Assembler.StoreByteImmediate(ContextRegister, offsetof(NativeContext, m_HasWrittenWatched), 1);
+			m_Assembler.Bind(isNotWatched);
+
+			m_Assembler.AndImmediate(Assembler::RDX, PageMask);
+			m_Assembler.StoreIndexed(Assembler::RSI, Assembler::RDX, Assembler::RAX);
+		}
+
+		// Jumps to the address in rcx, staying in the region if it's one of its instructions
+		void ComputedJump()
+		{
+			m_Assembler.Mov(Assembler::RAX, Assembler::RCX);
+			m_Assembler.AddImmediate(Assembler::RCX, -static_cast<std::int32_t>(m_FirstAddress));
+			m_Assembler.CmpImmediate(Assembler::RCX, static_cast<std::int32_t>(m_EndAddress - m_FirstAddress));
+			m_Assembler.JumpIf(Assembler::AboveOrEqual, m_Epilogue);
+			m_Assembler.LoadLabelAddress(Assembler::RDX, m_JumpTable);
+			m_Assembler.LoadIndexedInt32(Assembler::RCX, Assembler::RDX, Assembler::RCX);
+			m_Assembler.Add(Assembler::RCX, Assembler::RDX);
+			m_Assembler.JumpTo(Assembler::RCX);
+		}
+
+		void CompileInstruction(IntCodeAddress address, const Instruction& instruction)
+		{
+			// Nothing is modified before the last guard: leaving through it means starting over
+			const Assembler::Label deoptimize = GetExit(static_cast<std::int64_t>(address));
+
+			switch (instruction.m_OpCode)
+			{
+			case OpCode::ADD:
+			case OpCode::MUL:
+				LoadParameter(Assembler::RAX, instruction, 0, deoptimize);
+				LoadParameter(Assembler::RCX, instruction, 1, deoptimize);
+				ComputeAddress(Assembler::RDX, instruction, 2, deoptimize);
+				if (instruction.m_OpCode == OpCode::ADD)
+				{
+					m_Assembler.Add(Assembler::RAX, Assembler::RCX);
+				}
+				else
+				{
+					m_Assembler.Imul(Assembler::RAX, Assembler::RCX);
+				}
+				m_Assembler.JumpIf(Assembler::Overflow, deoptimize);
+				StoreResult(deoptimize);
+				break;
+			case OpCode::LT_:
+			case OpCode::EQU:
+				LoadParameter(Assembler::RAX, instruction, 0, deoptimize);
+				LoadParameter(Assembler::RCX, instruction, 1, deoptimize);
+				ComputeAddress(Assembler::RDX, instruction, 2, deoptimize);
+				m_Assembler.Cmp(Assembler::RAX, Assembler::RCX);
+				m_Assembler.SetCondition(instruction.m_OpCode == OpCode::LT_ ? Assembler::Less : Assembler::Equal, Assembler::RAX);
+				m_Assembler.MovZeroExtendByte(Assembler::RAX, Assembler::RAX);
+				StoreResult(deoptimize);
+				break;
+			case OpCode::JT_:
+			case OpCode::JF_:
+			{
+				const Assembler::Condition jumpCondition = instruction.m_OpCode == OpCode::JT_ ? Assembler::NotEqual : Assembler::Equal;
+				LoadParameter(Assembler::RAX, instruction, 0, deoptimize);
+				if (instruction.m_Modes[1] == ParameterMode::IMM)
+				{
+					m_Assembler.Test(Assembler::RAX, Assembler::RAX);
+					m_Assembler.JumpIf(jumpCondition, GetTarget(instruction.m_Parameters[1]));
+					break;
+				}
+
+				LoadParameter(Assembler::RCX, instruction, 1, deoptimize);
+				const Assembler::Label noJump = m_Assembler.NewLabel();
+				m_Assembler.Test(Assembler::RAX, Assembler::RAX);
+				m_Assembler.JumpIf(jumpCondition == Assembler::Equal ? Assembler::NotEqual : Assembler::Equal, noJump);
+				ComputedJump();
+				m_Assembler.Bind(noJump);
+				break;
+			}
+			case OpCode::RBS:
+				LoadParameter(Assembler::RAX, instruction, 0, deoptimize);
+				m_Assembler.Mov(Assembler::RCX, RelativeBaseRegister);
+				m_Assembler.Add(Assembler::RCX, Assembler::RAX);
+				m_Assembler.JumpIf(Assembler::Overflow, deoptimize);
+				m_Assembler.Mov(RelativeBaseRegister, Assembler::RCX);
+				break;
+			default:
+				// Never compiled, see IntCodeJit::TryCompile
+				m_Assembler.Jump(deoptimize);
+				break;
+			}
+		}
+
+		Assembler										m_Assembler;
+		const std::map<IntCodeAddress, Instruction>&	m_Instructions;
+		IntCodeAddress									m_FirstAddress;
+		IntCodeAddress									m_EndAddress;
+
+		Assembler::Label								m_Epilogue = 0;
+		Assembler::Label								m_JumpTable = 0;
+		std::map<IntCodeAddress, Assembler::Label>		m_InstructionLabels;
+		std::map<std::int64_t, Assembler::Label>		m_Exits;
+	};
+}
+
+IntCodeJit::IntCodeJit(std::size_t programSize)
+	: m_ProgramSize(programSize)
+{
+}
+
+IntCodeJit::~IntCodeJit() = default;
+
+IntCodeJit::IntCodeJit(const IntCodeJit& other)
+	: m_ProgramSize(other.m_ProgramSize)
+	, m_Regions(other.m_Regions)
+	, m_BackwardJumps(other.m_BackwardJumps)
+	, m_StalledRuns(other.m_StalledRuns)
+{
+	UpdateRegions();
+}
+
+bool IntCodeJit::TryRun(Memory& memory, IntCodeAddress jumpSource, IntCodeAddress& instructionPointer, std::int64_t& relativeBase, bool& hasWrittenProgram)
+{
+	auto entryPoint = m_EntryPoints.find(instructionPointer);
+	if (entryPoint == m_EntryPoints.end())
+	{
+		if (instructionPointer > jumpSource || ++m_BackwardJumps[instructionPointer] != HotThreshold || !TryCompile(memory, instructionPointer))
+		{
+			return false;
+		}
+
+		entryPoint = m_EntryPoints.find(instructionPointer);
+		if (entryPoint == m_EntryPoints.end())
+		{
+			return false;
+		}
+	}
+
+	memory.ExportPages(s_ZeroPage, m_ReadablePages, m_WritablePages);
+
+	NativeContext context;
+	context.m_ReadablePages = m_ReadablePages.data();
+	context.m_WritablePages = m_WritablePages.data();
+	context.m_PageCount = m_ReadablePages.size();
+	context.m_RelativeBase = relativeBase;
+	context.m_WatchedEnd = std::max<IntCodeAddress>(m_ProgramSize, m_CodeEnd);
+	context.m_HasWrittenWatched = 0;
+
+	const IntCodeAddress entryAddress = instructionPointer;
+	const NativeFunction function = reinterpret_cast<NativeFunction>(entryPoint->second.m_Region->m_Code);
+	instructionPointer = static_cast<IntCodeAddress>(function(&context, entryPoint->second.m_Code));
+	relativeBase = context.m_RelativeBase;
+	hasWrittenProgram = context.m_HasWrittenWatched != 0;
+
+	if (hasWrittenProgram)
+	{
+		Revalidate(memory);
+	}
+
+	if (instructionPointer != entryAddress)
+	{
+		if (!m_StalledRuns.empty())
+		{
+			m_StalledRuns.erase(entryAddress);
+		}
+	}
+	else if (++m_StalledRuns[entryAddress] >= MaxStalledRuns)
+	{
+		// Some guard fails right away every time, the interpreter does better
+		m_EntryPoints.erase(entryAddress);
+	}
+
+	return true;
+}
+
+void IntCodeJit::OnStore(IntCodeAddress address)
+{
+	if (address < m_CodeBegin || address >= m_CodeEnd)
+	{
+		return;
+	}
+
+	const auto isOverwritten = [address](const std::shared_ptr<const Region>& region) { return address >= region->m_FirstAddress && address < region->GetEndAddress(); };
+	m_Regions.erase(std::remove_if(m_Regions.begin(), m_Regions.end(), isOverwritten), m_Regions.end());
+	UpdateRegions();
+}
+
+void IntCodeJit::Revalidate(const Memory& memory)
+{
+	const auto isStale = [&memory](const std::shared_ptr<const Region>& region)
+	{
+		for (std::size_t offset = 0; offset < region->m_Program.size(); offset++)
+		{
+			if (memory.ReadValue(region->m_FirstAddress + offset) != region->m_Program[offset])
+			{
+				return true;
+			}
+		}
+
+		return false;
+	};
+
+	const std::size_t regionCount = m_Regions.size();
+	m_Regions.erase(std::remove_if(m_Regions.begin(), m_Regions.end(), isStale), m_Regions.end());
+	if (m_Regions.size() != regionCount)
+	{
+		UpdateRegions();
+	}
+}
+
+bool IntCodeJit::TryCompile(const Memory& memory, IntCodeAddress entryAddress)
+{
+#if INTCODE_HAS_JIT
+	using Instruction = RegionCompiler::Instruction;
+
+	// Everything reachable from the entry, through what can be compiled
+	std::map<IntCodeAddress, Instruction> instructions;
+	std::vector<IntCodeAddress> pending = { entryAddress };
+	while (!pending.empty())
+	{
+		const IntCodeAddress address = pending.back();
+		pending.pop_back();
+
+		if (address < entryAddress || address >= entryAddress + MaxRegionSpan || instructions.count(address) > 0)
+		{
+			continue;
+		}
+
+		const std::int64_t instructionCode = memory.ReadValue(address);
+		const int opCode = instructionCode < 0 ? -1 : static_cast<int>(instructionCode % 100);
+		const bool isCompiled = IntCodeDefinitions::IsValidOpCode(opCode) && opCode != static_cast<int>(OpCode::IN_) && opCode != static_cast<int>(OpCode::OU_) && opCode != static_cast<int>(OpCode::HLT);
+		if (!isCompiled)
+		{
+			continue;
+		}
+
+		Instruction instruction;
+		instruction.m_OpCode = static_cast<OpCode>(opCode);
+		instruction.m_Length = IntCodeDefinitions::GetParameterCount(instruction.m_OpCode) + 1;
+
+		bool isValid = true;
+		std::int64_t modes = instructionCode / 100;
+		for (std::size_t i = 0; i < instruction.m_Length - 1; i++, modes /= 10)
+		{
+			isValid &= modes % 10 <= static_cast<std::int64_t>(ParameterMode::REL);
+			instruction.m_Modes[i] = static_cast<ParameterMode>(modes % 10);
+			instruction.m_Parameters[i] = memory.ReadValue(address + 1 + i);
+		}
+
+		// Leave the odd ones to the interpreter
+		const bool storesToImmediate = instruction.m_Length == MaxInstructionLength && instruction.m_Modes[2] == ParameterMode::IMM;
+		if (!isValid || modes != 0 || storesToImmediate)
+		{
+			continue;
+		}
+
+		instructions[address] = instruction;
+		pending.push_back(address + instruction.m_Length);
+
+		const bool isJump = instruction.m_OpCode == OpCode::JT_ || instruction.m_OpCode == OpCode::JF_;
+		if (isJump && instruction.m_Modes[1] == ParameterMode::IMM && instruction.m_Parameters[1] >= 0)
+		{
+			pending.push_back(static_cast<IntCodeAddress>(instruction.m_Parameters[1]));
+		}
+	}
+
+	if (instructions.empty())
+	{
+		return false;
+	}
+
+	auto region = std::make_shared<Region>();
+	region->m_FirstAddress = instructions.begin()->first;
+	const IntCodeAddress endAddress = instructions.rbegin()->first + instructions.rbegin()->second.m_Length;
+	if (endAddress > static_cast<IntCodeAddress>(INT32_MAX))
+	{
+		return false;
+	}
+
+	for (IntCodeAddress address = region->m_FirstAddress; address < endAddress; address++)
+	{
+		region->m_Program.push_back(memory.ReadValue(address));
+	}
+
+	RegionCompiler compiler(instructions, region->m_FirstAddress, endAddress);
+	const std::vector<std::uint8_t> code = compiler.Compile(region->m_Entries);
+
+	const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+	const std::size_t codeSize = (code.size() + pageSize - 1) / pageSize * pageSize;
+	void* mapping = mmap(nullptr, codeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mapping == MAP_FAILED)
+	{
+		return false;
+	}
+
+	region->m_Code = mapping;
+	region->m_CodeSize = codeSize;
+	std::memcpy(mapping, code.data(), code.size());
+	if (mprotect(mapping, codeSize, PROT_READ | PROT_EXEC) != 0)
+	{
+		return false;
+	}
+
+	m_Regions.push_back(std::move(region));
+	UpdateRegions();
+	return true;
+#else
+	(void)memory;
+	(void)entryAddress;
+	return false;
+#endif
+}
+
+void IntCodeJit::UpdateRegions()
+{
+	m_EntryPoints.clear();
+	m_CodeBegin = m_Regions.empty() ? 0 : ~IntCodeAddress(0);
+	m_CodeEnd = 0;
+
+	for (const std::shared_ptr<const Region>& region : m_Regions)
+	{
+		m_CodeBegin = std::min(m_CodeBegin, region->m_FirstAddress);
+		m_CodeEnd = std::max(m_CodeEnd, region->GetEndAddress());
+
+		for (const auto& [address, offset] : region->m_Entries)
+		{
+			const auto stalledRuns = m_StalledRuns.find(address);
+			if (stalledRuns == m_StalledRuns.end() || stalledRuns->second < MaxStalledRuns)
+			{
+				m_EntryPoints[address] = { region.get(), static_cast<const std::uint8_t*>(region->m_Code) + offset };
+			}
+		}
+	}
+}
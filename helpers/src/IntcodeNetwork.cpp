@@ -0,0 +1,293 @@
+#include <IntcodeNetwork.h>
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+IntCodeTopology IntCodeTopology::Chain(const IntCodeProgramImagePtr& image, std::size_t length)
+{
+	IntCodeTopology topology;
+
+	for (std::size_t i = 0; i < length; i++)
+	{
+		topology.AddNode(image);
+		if (i > 0)
+		{
+			topology.Connect(i - 1, i);
+		}
+	}
+
+	return topology;
+}
+
+IntCodeTopology IntCodeTopology::Ring(const IntCodeProgramImagePtr& image, std::size_t length)
+{
+	IntCodeTopology topology = Chain(image, length);
+	if (length > 0)
+	{
+		topology.Connect(length - 1, 0);
+	}
+
+	return topology;
+}
+
+IntCodeTopology::NodeId IntCodeTopology::AddNode(IntCodeProgramImagePtr image, std::vector<IntCodeValue> initialInputs)
+{
+	m_Nodes.push_back({ std::move(image), std::move(initialInputs) });
+	return m_Nodes.size() - 1;
+}
+
+void IntCodeTopology::Connect(NodeId from, NodeId to)
+{
+	assert(from < m_Nodes.size() && to < m_Nodes.size());
+	m_Edges.push_back({ from, to });
+}
+
+void IntCodeTopology::SetInitialInputs(NodeId node, std::vector<IntCodeValue> initialInputs)
+{
+	m_Nodes[node].m_InitialInputs = std::move(initialInputs);
+}
+
+void IntCodeTopology::CollectOutputs(NodeId node)
+{
+	m_Nodes[node].m_CollectsOutputs = true;
+}
+
+template<typename ValuePolicy>
+BasicIntCodeNetwork<ValuePolicy>::BasicIntCodeNetwork(const IntCodeTopology& topology)
+{
+	for (const IntCodeTopology::Node& topologyNode : topology.GetNodes())
+	{
+		Node& node = *m_Nodes.emplace_back(std::make_unique<Node>(topologyNode.m_Image));
+		node.m_CollectsOutputs = topologyNode.m_CollectsOutputs;
+	}
+
+	for (const IntCodeTopology::Edge& edge : topology.GetEdges())
+	{
+		m_Nodes[edge.m_From]->m_Receivers.push_back(edge.m_To);
+		m_Nodes[edge.m_To]->m_Senders.push_back(edge.m_From);
+	}
+
+	for (const IntCodeTopology::Edge& edge : topology.GetEdges())
+	{
+		Node& sender = *m_Nodes[edge.m_From];
+		Node& receiver = *m_Nodes[edge.m_To];
+
+		if (sender.m_Receivers.size() == 1 && receiver.m_Senders.size() == 1 && !sender.m_CollectsOutputs)
+		{
+			// A private line: the receiver reads straight from the sender's output
+			receiver.m_Computer.SetInputChannel(sender.m_Computer.GetOutputChannel());
+			continue;
+		}
+
+		auto channel = std::make_shared<IntCodeChannel<Value>>();
+		sender.m_OutgoingChannels.push_back(channel);
+		sender.m_ForwardsOutputs = true;
+		receiver.m_IncomingChannels.push_back(channel);
+		receiver.m_GathersInputs = true;
+	}
+
+	for (std::size_t i = 0; i < m_Nodes.size(); i++)
+	{
+		Node& node = *m_Nodes[i];
+
+		// Nobody would ever read them otherwise
+		if (node.m_Receivers.empty())
+		{
+			node.m_CollectsOutputs = true;
+			node.m_ForwardsOutputs = true;
+		}
+
+		std::vector<Value> initialInputs;
+		for (const IntCodeValue& bigInput : topology.GetNodes()[i].m_InitialInputs)
+		{
+			Value input;
+			if (!ValuePolicy::TryFromBigInt(bigInput, input))
+			{
+				std::cerr << "Initial input " << bigInput << " of node " << i << " doesn't fit in this network" << std::endl;
+				break;
+			}
+
+			initialInputs.push_back(std::move(input));
+		}
+
+		FeedInputs(i, initialInputs);
+	}
+}
+
+template<typename ValuePolicy>
+std::size_t BasicIntCodeNetwork<ValuePolicy>::FeedInputs(NodeId node, std::span<const Value> inputs)
+{
+	return m_Nodes[node]->m_Computer.FeedInputs(inputs);
+}
+
+template<typename ValuePolicy>
+void BasicIntCodeNetwork<ValuePolicy>::Run(WorkStealingThreadPool& pool)
+{
+	m_Pool = &pool;
+
+	for (NodeId node = 0; node < m_Nodes.size(); node++)
+	{
+		Wake(node);
+	}
+
+	pool.Wait();
+	m_Pool = nullptr;
+}
+
+template<typename ValuePolicy>
+bool BasicIntCodeNetwork<ValuePolicy>::IsHalted() const
+{
+	return std::all_of(m_Nodes.begin(), m_Nodes.end(), [](const std::unique_ptr<Node>& node) { return node->m_Computer.IsHalted(); });
+}
+
+template<typename ValuePolicy>
+void BasicIntCodeNetwork<ValuePolicy>::Wake(NodeId nodeId)
+{
+	Node& node = *m_Nodes[nodeId];
+
+	NodeState state = node.m_State.load();
+	while (true)
+	{
+		switch (state)
+		{
+		case NodeState::Parked:
+			if (node.m_State.compare_exchange_weak(state, NodeState::Scheduled))
+			{
+				m_Pool->Submit([this, nodeId]() { RunNode(nodeId); });
+				return;
+			}
+			break;
+		case NodeState::Running:
+			// Whatever woke us might have come too late for the current run
+			if (node.m_State.compare_exchange_weak(state, NodeState::Rescheduled))
+			{
+				return;
+			}
+			break;
+		default:
+			return;
+		}
+	}
+}
+
+template<typename ValuePolicy>
+void BasicIntCodeNetwork<ValuePolicy>::RunNode(NodeId nodeId)
+{
+	Node& node = *m_Nodes[nodeId];
+
+	while (true)
+	{
+		node.m_State.store(NodeState::Running);
+
+		while (Step(node)) {}
+
+		// Halted (or failed for good), and with nothing left to hand out
+		const bool isStuck = !node.m_Computer.IsPaused() && !node.m_Computer.IsAwaitingInput();
+		if (isStuck && (!node.m_ForwardsOutputs || node.m_Computer.GetOutputChannel()->IsEmpty()))
+		{
+			node.m_State.store(NodeState::Stopped);
+			return;
+		}
+
+		NodeState expected = NodeState::Running;
+		if (node.m_State.compare_exchange_strong(expected, NodeState::Parked))
+		{
+			return;
+		}
+	}
+}
+
+template<typename ValuePolicy>
+bool BasicIntCodeNetwork<ValuePolicy>::Step(Node& node)
+{
+	Computer& computer = node.m_Computer;
+
+	const std::size_t popped = computer.GetInputChannel()->GetPoppedCount();
+	const std::size_t pushed = computer.GetOutputChannel()->GetPushedCount();
+
+	const std::size_t gathered = node.m_GathersInputs ? GatherInputs(node) : 0;
+
+	computer.Execute();
+
+	// With a private line, the channel itself tells what went through
+	const std::size_t consumed = node.m_GathersInputs ? gathered : computer.GetInputChannel()->GetPoppedCount() - popped;
+	const std::size_t produced = node.m_ForwardsOutputs ? ForwardOutputs(node) : computer.GetOutputChannel()->GetPushedCount() - pushed;
+
+	if (produced > 0)
+	{
+		for (NodeId receiver : node.m_Receivers)
+		{
+			Wake(receiver);
+		}
+	}
+
+	if (consumed > 0)
+	{
+		// They might be stuck on a full channel
+		for (NodeId sender : node.m_Senders)
+		{
+			Wake(sender);
+		}
+	}
+
+	// Inputs we had no room for, or outputs we just made room for
+	const bool hasPendingInputs = computer.IsAwaitingInput() && std::any_of(node.m_IncomingChannels.begin(), node.m_IncomingChannels.end(), [](const IntCodeChannelPtr<Value>& channel) { return !channel->IsEmpty(); });
+	const bool hasRoomForOutputs = computer.IsPaused() && produced > 0;
+	return hasPendingInputs || hasRoomForOutputs;
+}
+
+template<typename ValuePolicy>
+std::size_t BasicIntCodeNetwork<ValuePolicy>::GatherInputs(Node& node)
+{
+	IntCodeChannel<Value>& input = *node.m_Computer.GetInputChannel();
+
+	std::size_t gathered = 0;
+	for (const IntCodeChannelPtr<Value>& channel : node.m_IncomingChannels)
+	{
+		for (const Value* value = channel->Front(); value != nullptr && input.GetSize() < input.GetCapacity(); value = channel->Front())
+		{
+			input.TryPush(*value);
+			channel->PopFront();
+			gathered++;
+		}
+	}
+
+	return gathered;
+}
+
+template<typename ValuePolicy>
+std::size_t BasicIntCodeNetwork<ValuePolicy>::ForwardOutputs(Node& node)
+{
+	IntCodeChannel<Value>& output = *node.m_Computer.GetOutputChannel();
+
+	const auto isFull = [](const IntCodeChannelPtr<Value>& channel) { return channel->GetSize() == channel->GetCapacity(); };
+
+	std::size_t forwarded = 0;
+	for (const Value* value = output.Front(); value != nullptr; value = output.Front())
+	{
+		// Every receiver gets every output: wait until they all have room
+		if (std::any_of(node.m_OutgoingChannels.begin(), node.m_OutgoingChannels.end(), isFull))
+		{
+			break;
+		}
+
+		for (const IntCodeChannelPtr<Value>& channel : node.m_OutgoingChannels)
+		{
+			channel->TryPush(*value);
+		}
+
+		if (node.m_CollectsOutputs)
+		{
+			node.m_CollectedOutputs.push_back(*value);
+		}
+
+		output.PopFront();
+		forwarded++;
+	}
+
+	return forwarded;
+}
+
+template class BasicIntCodeNetwork<IntCodeInt64Policy>;
+template class BasicIntCodeNetwork<IntCodeBigIntPolicy>;
@@ -0,0 +1,100 @@
+#include <IntcodeProfiler.h>
+
+void IntCodeProfiler::Merge(const IntCodeProfiler& other)
+{
+	for (std::size_t i = 0; i < OpCodeCount; i++)
+	{
+		m_OpCodeCounts[i] += other.m_OpCodeCounts[i];
+	}
+
+	m_InputWaits += other.m_InputWaits;
+	m_OutputWaits += other.m_OutputWaits;
+
+	other.ForEachAddress([this](IntCodeAddress address, const AddressProfile& otherProfile)
+	{
+		AddressProfile& profile = GetAddressProfile(address);
+		profile.m_OpCode = otherProfile.m_Hits > 0 ? otherProfile.m_OpCode : profile.m_OpCode;
+		profile.m_Hits += otherProfile.m_Hits;
+		profile.m_TakenBranches += otherProfile.m_TakenBranches;
+		profile.m_UntakenBranches += otherProfile.m_UntakenBranches;
+		profile.m_Waits += otherProfile.m_Waits;
+	});
+}
+
+void IntCodeProfiler::Clear()
+{
+	m_OpCodeCounts = {};
+	m_InputWaits = 0;
+	m_OutputWaits = 0;
+	m_Addresses.clear();
+	m_FarAddresses.clear();
+}
+
+std::uint64_t IntCodeProfiler::GetInstructionCount() const
+{
+	std::uint64_t count = 0;
+	for (std::uint64_t opCodeCount : m_OpCodeCounts)
+	{
+		count += opCodeCount;
+	}
+
+	return count;
+}
+
+IntCodeProfiler::AddressProfile IntCodeProfiler::GetAddressProfile(IntCodeAddress address) const
+{
+	if (address < m_Addresses.size())
+	{
+		return m_Addresses[address];
+	}
+
+	const auto it = m_FarAddresses.find(address);
+	return it != m_FarAddresses.end() ? it->second : AddressProfile();
+}
+
+void IntCodeProfiler::WriteJson(std::ostream& output) const
+{
+	output << "{\n";
+	output << "\t\"instructions\": " << GetInstructionCount() << ",\n";
+	output << "\t\"inputWaits\": " << m_InputWaits << ",\n";
+	output << "\t\"outputWaits\": " << m_OutputWaits << ",\n";
+
+	output << "\t\"opcodes\": {";
+	for (std::size_t i = 0; i < OpCodeCount; i++)
+	{
+		const OpCode opCode = i == 0 ? OpCode::HLT : static_cast<OpCode>(i);
+		output << (i == 0 ? " " : ", ") << '"' << GetOpCodeName(opCode) << "\": " << m_OpCodeCounts[i];
+	}
+	output << " },\n";
+
+	output << "\t\"addresses\": [";
+	bool isFirst = true;
+	ForEachAddress([&](IntCodeAddress address, const AddressProfile& profile)
+	{
+		output << (isFirst ? "\n" : ",\n");
+		output << "\t\t{ \"address\": " << address << ", \"opcode\": \"" << GetOpCodeName(profile.m_OpCode) << "\", \"hits\": " << profile.m_Hits;
+		if (profile.m_OpCode == OpCode::JT_ || profile.m_OpCode == OpCode::JF_)
+		{
+			output << ", \"taken\": " << profile.m_TakenBranches << ", \"notTaken\": " << profile.m_UntakenBranches;
+		}
+		if (profile.m_Waits > 0)
+		{
+			output << ", \"waits\": " << profile.m_Waits;
+		}
+		output << " }";
+		isFirst = false;
+	});
+	output << (isFirst ? "]\n" : "\n\t]\n");
+	output << "}\n";
+}
+
+void IntCodeProfiler::WriteFoldedStacks(std::ostream& output) const
+{
+	ForEachAddress([&](IntCodeAddress address, const AddressProfile& profile)
+	{
+		if (profile.m_Hits > 0)
+		{
+			output << GetOpCodeName(profile.m_OpCode) << ";@" << address << ' ' << profile.m_Hits << '\n';
+		}
+	});
+}
@@ -1,386 +1,1596 @@
 #include <IntcodeProgram.h>
+#include <IntcodeJit.h>
 
 #include <iostream>
-#include <fstream>
 #include <sstream>
-#include <unordered_set>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <limits>
+#include <type_traits>
 
-void IntCodeMemory::Reset(IntCodeProgram initialProgram)
+namespace
 {
-	m_SequentialMemory.clear();
-	m_SequentialMemory = std::move(initialProgram);
-	m_UnboundedMemory.clear();
+	// Shared by every kind of computer: run until stuck, hand out the outputs, then either
+	// wait for an input or stop for good.
+	template<typename Value, typename Computer>
+	IntCodeCoroutine<Value> RunAsCoroutine(Computer& computer)
+	{
+		while (true)
+		{
+			computer.Execute();
+
+			for (Value output; computer.DrainOutputs(std::span(&output, 1)) == 1;)
+			{
+				co_yield std::move(output);
+			}
+
+			if (computer.IsAwaitingInput())
+			{
+				const Value input = co_await typename IntCodeCoroutine<Value>::InputRequest();
+				computer.FeedInputs(std::span(&input, 1));
+			}
+			else if (!computer.IsPaused())
+			{
+				co_return;
+			}
+		}
+	}
 }
 
-void IntCodeMemory::StoreValue(const IntCodeAddress& address, IntCodeValue value)
+template<typename ValuePolicy>
+void IntCodeMemory<ValuePolicy>::Reset(const std::vector<Value>& initialProgram)
 {
-	assert(address >= 0);
+	m_Directory.clear();
+	m_FarPages.clear();
+
+	for (std::size_t firstAddress = 0; firstAddress < initialProgram.size(); firstAddress += PageSize)
+	{
+		const std::size_t lastAddress = std::min(firstAddress + PageSize, initialProgram.size());
+		std::copy(initialProgram.begin() + firstAddress, initialProgram.begin() + lastAddress, GetWritablePage(firstAddress >> PageBits).begin());
+	}
+}
 
-	if (IsAddressInSequentialMemoryRange(address))
+template<typename ValuePolicy>
+template<typename T>
+void IntCodeMemory<ValuePolicy>::MakeWritable(std::shared_ptr<T>& pointer)
+{
+	if (!pointer)
+	{
+		pointer = std::make_shared<T>();
+	}
+	else if (pointer.use_count() > 1)
 	{
-		m_SequentialMemory[address.convert_to<std::size_t>()] = std::move(value);
+		pointer = std::make_shared<T>(*pointer);
 	}
 	else
 	{
-		m_UnboundedMemory[address] = value;
+		// Pairs with the release of the last other owner, which might have been reading it
+		std::atomic_thread_fence(std::memory_order_acquire);
 	}
 }
 
-IntCodeValue IntCodeMemory::ReadValue(const IntCodeAddress& address) const
+template<typename ValuePolicy>
+const typename IntCodeMemory<ValuePolicy>::Page* IntCodeMemory<ValuePolicy>::FindPage(std::size_t pageIndex) const
 {
-	assert(address >= 0);
-
-	if (IsAddressInSequentialMemoryRange(address))
+	const std::size_t tableIndex = pageIndex >> TableBits;
+	if (tableIndex < m_Directory.size())
 	{
-		return m_SequentialMemory[address.convert_to<std::size_t>()];
+		const std::shared_ptr<PageTable>& table = m_Directory[tableIndex];
+		return table ? (*table)[pageIndex & TableMask].get() : nullptr;
 	}
-	else
+
+	if (tableIndex < MaxDirectorySize || m_FarPages.empty())
 	{
-		return m_UnboundedMemory.count(address) > 0 ? m_UnboundedMemory.at(address) : 0;
+		return nullptr;
 	}
+
+	const auto it = m_FarPages.find(pageIndex);
+	return it != m_FarPages.end() ? it->second.get() : nullptr;
 }
 
-bool IntCodeMemory::IsAddressInSequentialMemoryRange(const IntCodeAddress& address) const
+template<typename ValuePolicy>
+typename IntCodeMemory<ValuePolicy>::Page& IntCodeMemory<ValuePolicy>::GetWritablePage(std::size_t pageIndex)
 {
-	if (address > IntCodeAddress(std::numeric_limits<std::size_t>::max()))
+	const std::size_t tableIndex = pageIndex >> TableBits;
+	if (tableIndex >= MaxDirectorySize)
 	{
-		return false;
+		std::shared_ptr<Page>& page = m_FarPages[pageIndex];
+		MakeWritable(page);
+		return *page;
+	}
+
+	if (tableIndex >= m_Directory.size())
+	{
+		m_Directory.resize(tableIndex + 1);
 	}
 
-	return address.convert_to<std::size_t>() < m_SequentialMemory.size();
+	std::shared_ptr<PageTable>& table = m_Directory[tableIndex];
+	MakeWritable(table);
+
+	std::shared_ptr<Page>& page = (*table)[pageIndex & TableMask];
+	MakeWritable(page);
+	return *page;
 }
 
-IntCodeComputer::InstructionSetHolder::InstructionSetHolder()
+template<typename ValuePolicy>
+void IntCodeMemory<ValuePolicy>::StoreValue(IntCodeAddress address, Value value)
 {
-	m_InstructionSet[OpCode::ADD] = &IntCodeComputer::Add;
-	m_InstructionSet[OpCode::MUL] = &IntCodeComputer::Mul;
-	m_InstructionSet[OpCode::IN_] = &IntCodeComputer::Input;
-	m_InstructionSet[OpCode::OU_] = &IntCodeComputer::Output;
-	m_InstructionSet[OpCode::JT_] = &IntCodeComputer::JumpIfTrue;
-	m_InstructionSet[OpCode::JF_] = &IntCodeComputer::JumpIfFalse;
-	m_InstructionSet[OpCode::LT_] = &IntCodeComputer::LessThan;
-	m_InstructionSet[OpCode::EQU] = &IntCodeComputer::Equals;
-	m_InstructionSet[OpCode::RBS] = &IntCodeComputer::Rebase;
-	m_InstructionSet[OpCode::HLT] = &IntCodeComputer::Halt;
+	GetWritablePage(address >> PageBits)[address & PageMask] = std::move(value);
 }
 
-bool IntCodeComputer::IsValueAnInstructionCode(IntCodeValue value)
+template<typename ValuePolicy>
+void IntCodeMemory<ValuePolicy>::SwapValue(IntCodeAddress address, Value& value)
 {
-	static const std::unordered_set<IntCodeValue> ValidOpCodes =
-	{
-		OpCode::ADD,
-		OpCode::MUL,
-		OpCode::IN_,
-		OpCode::OU_,
-		OpCode::JT_,
-		OpCode::JF_,
-		OpCode::LT_,
-		OpCode::EQU,
-		OpCode::RBS,
-		OpCode::HLT
-	};
+	using std::swap;
+	swap(GetWritablePage(address >> PageBits)[address & PageMask], value);
+}
 
-	return ValidOpCodes.count(value % 100) > 0;
+template<typename ValuePolicy>
+const typename IntCodeMemory<ValuePolicy>::Value& IntCodeMemory<ValuePolicy>::ReadValue(IntCodeAddress address) const
+{
+	const Page* page = FindPage(address >> PageBits);
+	return page ? (*page)[address & PageMask] : ZeroValue;
 }
 
-bool IntCodeComputer::IsValueAParameterMode(IntCodeValue value)
+template<typename ValuePolicy>
+void IntCodeMemory<ValuePolicy>::WriteSnapshot(std::ostream& output, const IntCodeMemory& base) const
 {
-	static const std::unordered_set<IntCodeValue> ValidParameterModes =
+	// By address, so that the same state always gives the same snapshot
+	std::vector<std::pair<std::size_t, const Page*>> changedPages;
+	ForEachPage([&](std::size_t firstAddress, const Page& page)
 	{
-		ParameterMode::POS,
-		ParameterMode::IMM,
-		ParameterMode::REL
-	};
+		if (base.FindPage(firstAddress >> PageBits) != &page)
+		{
+			changedPages.emplace_back(firstAddress, &page);
+		}
+	});
+	std::sort(changedPages.begin(), changedPages.end());
 
-	return ValidParameterModes.count(value) > 0;
+	IntCodeSnapshot::WriteInteger(output, changedPages.size());
+	for (const auto& [firstAddress, page] : changedPages)
+	{
+		IntCodeSnapshot::WriteInteger(output, firstAddress);
+		IntCodeSnapshot::WriteValues<ValuePolicy>(output, page->data(), PageSize);
+	}
 }
 
-std::vector<IntCodeComputer::ParameterMode> IntCodeComputer::ExtractParameterModes(IntCodeValue value, std::size_t count)
+template<typename ValuePolicy>
+bool IntCodeMemory<ValuePolicy>::ReadSnapshot(std::istream& input)
 {
-	std::vector<ParameterMode> parameterModes(count, ParameterMode::POS);
-	
-	value /= 100;
-	std::size_t idx = 0;
-	while (idx < count && value > 0)
+	std::uint64_t pageCount = 0;
+	if (!IntCodeSnapshot::ReadInteger(input, pageCount))
 	{
-		IntCodeValue parameterModeValue = value % 10;
-		const bool isValid = IsValueAParameterMode(parameterModeValue);
-		
-		if (!isValid)
+		return false;
+	}
+
+	for (std::uint64_t i = 0; i < pageCount; i++)
+	{
+		std::uint64_t firstAddress = 0;
+		if (!IntCodeSnapshot::ReadInteger(input, firstAddress) || (firstAddress & PageMask) != 0)
 		{
-			std::cerr << "Unexpected Parameter Mode " << parameterModeValue << std::endl;
+			return false;
+		}
+
+		Page& page = GetWritablePage(firstAddress >> PageBits);
+		if (!IntCodeSnapshot::ReadValues<ValuePolicy>(input, page.data(), PageSize))
+		{
+			return false;
 		}
-		
-		const ParameterMode parameterMode = isValid ? static_cast<ParameterMode>(parameterModeValue.convert_to<int>()) : ParameterMode::POS;
-		parameterModes[idx++] = parameterMode;
-		value /= 10;
 	}
 
-	return parameterModes;
+	return true;
 }
 
-IntCodeValue IntCodeComputer::GetValueFromParameterMode(ParameterMode mode, IntCodeValue value) const
+template<typename ValuePolicy>
+void IntCodeMemory<ValuePolicy>::ExportPages(const Page& zeroPage, std::vector<const Value*>& readablePages, std::vector<Value*>& writablePages)
 {
-	switch (mode)
+	const std::size_t pageCount = m_Directory.size() << TableBits;
+	readablePages.assign(pageCount, zeroPage.data());
+	writablePages.assign(pageCount, nullptr);
+
+	bool hasWritablePages = false;
+	for (std::size_t tableIndex = 0; tableIndex < m_Directory.size(); tableIndex++)
 	{
-	case ParameterMode::IMM:
-		return value;
-	case ParameterMode::POS:
-		return m_Memory.ReadValue(static_cast<IntCodeAddress>(value));
-	case ParameterMode::REL:
-		return m_Memory.ReadValue(static_cast<IntCodeAddress>(value) + m_RelativeBase);
-	default:
-		std::cerr << "Unrecognized ParameterMode " << static_cast<int>(mode) << std::endl;
-		return 0;
+		const std::shared_ptr<PageTable>& table = m_Directory[tableIndex];
+		if (!table)
+		{
+			continue;
+		}
+
+		for (std::size_t pageOffset = 0; pageOffset < TableSize; pageOffset++)
+		{
+			const std::shared_ptr<Page>& page = (*table)[pageOffset];
+			if (!page)
+			{
+				continue;
+			}
+
+			const std::size_t pageIndex = (tableIndex << TableBits) + pageOffset;
+			readablePages[pageIndex] = page->data();
+
+			// Same as what MakeWritable would leave untouched
+			if (table.use_count() == 1 && page.use_count() == 1)
+			{
+				writablePages[pageIndex] = page->data();
+				hasWritablePages = true;
+			}
+		}
+	}
+
+	if (hasWritablePages)
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
 	}
 }
 
-IntCodeAddress IntCodeComputer::GetAddressFromParameterMode(ParameterMode mode, IntCodeValue value) const
+template<typename ValuePolicy>
+template<typename SourcePolicy>
+bool IntCodeMemory<ValuePolicy>::TryConvertFrom(const IntCodeMemory<SourcePolicy>& other)
 {
-	switch (mode)
+	IntCodeMemory convertedMemory;
+
+	bool converted = true;
+	other.ForEachPage([&](IntCodeAddress firstAddress, const typename IntCodeMemory<SourcePolicy>::Page& otherPage)
 	{
-	case ParameterMode::POS:
-		return value;
-	case ParameterMode::REL:
-		return value + m_RelativeBase;
-	case ParameterMode::IMM:
-		std::cerr << "Cannot write on an Immediate" << std::endl;
-	default:
-		std::cerr << "Unrecognized ParameterMode " << static_cast<int>(mode) << std::endl;
-		return 0;
+		Page& page = convertedMemory.GetWritablePage(firstAddress >> PageBits);
+		for (std::size_t offset = 0; offset < PageSize && converted; offset++)
+		{
+			converted = ValuePolicy::TryFromBigInt(SourcePolicy::ToBigInt(otherPage[offset]), page[offset]);
+		}
+	});
+
+	if (converted)
+	{
+		*this = std::move(convertedMemory);
 	}
+
+	return converted;
 }
 
-IntCodeProgram IntCodeComputer::LoadFromFile(const std::string& filename)
+template<typename ValuePolicy, typename ProfilingPolicy>
+void BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::DecodeInstruction(IntCodeAddress address, DecodedInstruction& instruction) const
 {
-	IntCodeProgram program;
+	const Value& instructionCode = m_Memory.ReadValue(address);
+	const int opCode = instructionCode < 0 ? -1 : ValuePolicy::ToInt(instructionCode % 100);
+
+	instruction.m_Superinstruction = Superinstruction::None;
+
+	if (!IsValidOpCode(opCode))
+	{
+		instruction.m_State = DecodedInstruction::State::Invalid;
+		instruction.m_Length = 1;
+		instruction.m_FirstLength = 1;
+		return;
+	}
+
+	instruction.m_State = DecodedInstruction::State::Valid;
+	instruction.m_OpCode = static_cast<OpCode>(opCode);
 
-	std::ifstream input(filename);
-	if (!input.is_open())
+	const std::size_t parameterCount = GetParameterCount(instruction.m_OpCode);
+	instruction.m_Length = static_cast<std::uint8_t>(parameterCount + 1);
+	instruction.m_FirstLength = instruction.m_Length;
+
+	Value modes = instructionCode / 100;
+	for (std::size_t idx = 0; idx < parameterCount; idx++)
 	{
-		return program;
+		const int parameterModeValue = ValuePolicy::ToInt(modes % 10);
+		const bool isValid = parameterModeValue == static_cast<int>(ParameterMode::POS)
+			|| parameterModeValue == static_cast<int>(ParameterMode::IMM)
+			|| parameterModeValue == static_cast<int>(ParameterMode::REL);
+
+		if (!isValid)
+		{
+			std::cerr << "Unexpected Parameter Mode " << parameterModeValue << std::endl;
+		}
+
+		instruction.m_ParameterModes[idx] = isValid ? static_cast<ParameterMode>(parameterModeValue) : ParameterMode::POS;
+		instruction.m_Parameters[idx] = m_Memory.ReadValue(address + idx + 1);
+		modes /= 10;
 	}
+}
 
-	std::string programLine;
-	while (std::getline(input, programLine))
+template<typename ValuePolicy, typename ProfilingPolicy>
+const typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::DecodedInstruction& BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::FetchCurrentInstruction()
+{
+	if (m_InstructionPointer + MaxInstructionLength <= m_DecodedInstructions.size())
 	{
-		std::stringstream programStringStream(programLine);
-		std::string intCodeValueString;
-		while (std::getline(programStringStream, intCodeValueString, ','))
+		DecodedInstruction& instruction = m_DecodedInstructions[m_InstructionPointer];
+		if (instruction.m_State == DecodedInstruction::State::Stale)
 		{
-			program.emplace_back(intCodeValueString);
+			DecodeInstruction(m_InstructionPointer, instruction);
+
+			// Profiles count every single instruction, and watches check every single one
+			if constexpr (!ProfilingPolicy::IsEnabled)
+			{
+				if (m_WatchedCells.empty())
+				{
+					FuseInstructions(m_InstructionPointer, instruction);
+				}
+			}
 		}
+
+		return instruction;
 	}
 
-	return program;
+	// Near the end of the program, or past it: parameters might live in the unbounded
+	// memory, where writes don't invalidate anything. Don't bother caching.
+	DecodeInstruction(m_InstructionPointer, m_ScratchInstruction);
+	return m_ScratchInstruction;
 }
 
-IntCodeComputer::IntCodeComputer(std::string fileName)
-	: m_OriginalProgram(LoadFromFile(fileName))
+template<typename ValuePolicy, typename ProfilingPolicy>
+void BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::FuseInstructions(IntCodeAddress address, DecodedInstruction& instruction) const
 {
-	Reset();
+	if (instruction.m_State != DecodedInstruction::State::Valid)
+	{
+		return;
+	}
+
+	const OpCode opCode = instruction.m_OpCode;
+	const std::array<ParameterMode, 3>& modes = instruction.m_ParameterModes;
+	const std::array<Value, 3>& parameters = instruction.m_Parameters;
+
+	const bool isCompare = opCode == OpCode::LT_ || opCode == OpCode::EQU;
+	const bool isStraight = opCode == OpCode::ADD || opCode == OpCode::MUL || isCompare || opCode == OpCode::RBS;
+	if (!isStraight || (opCode != OpCode::RBS && modes[2] == ParameterMode::IMM))
+	{
+		return;
+	}
+
+	// Both instructions must be cached, see FetchCurrentInstruction
+	const IntCodeAddress nextAddress = address + instruction.m_Length;
+	if (nextAddress + MaxInstructionLength > m_DecodedInstructions.size())
+	{
+		return;
+	}
+
+	DecodedInstruction next;
+	DecodeInstruction(nextAddress, next);
+	if (next.m_State != DecodedInstruction::State::Valid)
+	{
+		return;
+	}
+
+	const bool isBranch = next.m_OpCode == OpCode::JT_ || next.m_OpCode == OpCode::JF_;
+	if (isCompare && isBranch && next.m_ParameterModes[0] == modes[2] && next.m_Parameters[0] == parameters[2])
+	{
+		instruction.m_Superinstruction = Superinstruction::CompareAndBranch;
+	}
+	else if (next.m_OpCode != OpCode::IN_ && next.m_OpCode != OpCode::OU_ && next.m_OpCode != OpCode::HLT)
+	{
+		instruction.m_Superinstruction = Superinstruction::Sequence;
+	}
+	else
+	{
+		return;
+	}
+
+	instruction.m_Next = std::move(static_cast<Operation&>(next));
+	instruction.m_Length = static_cast<std::uint8_t>(instruction.m_FirstLength + next.m_Length);
 }
 
-void IntCodeComputer::SetNounAndVerb(InitData initData)
+template<typename ValuePolicy, typename ProfilingPolicy>
+void BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::InvalidateDecodedInstructions(IntCodeAddress writtenAddress)
 {
-	m_Memory.StoreValue(1, initData.noun);
-	m_Memory.StoreValue(2, initData.verb);
+	if (writtenAddress >= m_DecodedInstructions.size())
+	{
+		return;
+	}
+
+	const IntCodeAddress firstAddress = writtenAddress >= MaxFusedLength - 1 ? writtenAddress - (MaxFusedLength - 1) : 0;
+	for (IntCodeAddress address = firstAddress; address <= writtenAddress; address++)
+	{
+		DecodedInstruction& instruction = m_DecodedInstructions[address];
+		if (address + instruction.m_Length > writtenAddress)
+		{
+			instruction.m_State = DecodedInstruction::State::Stale;
+		}
+	}
 }
 
-void IntCodeComputer::Reset()
+template<typename ValuePolicy, typename ProfilingPolicy>
+void BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::StoreValue(IntCodeAddress address, Value value)
 {
-	m_Memory.Reset(m_OriginalProgram);
-	m_InstructionPointer = 0;
-	m_RelativeBase = 0;
-	m_Status = ExecutionStatus::NotStarted;
-	
-	m_InputStream.str(std::string());
-	m_InputStream.clear();
+	m_Memory.StoreValue(address, std::move(value));
+	OnStore(address);
+}
 
-	m_OutputStream.str(std::string());
-	m_OutputStream.clear();
+template<typename ValuePolicy, typename ProfilingPolicy>
+void BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::SwapValue(IntCodeAddress address, Value& value)
+{
+	m_Memory.SwapValue(address, value);
+	OnStore(address);
 }
 
-void IntCodeComputer::Execute()
+template<typename ValuePolicy, typename ProfilingPolicy>
+void BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::OnStore(IntCodeAddress address)
 {
-	m_Status = ExecutionStatus::Running;
+	InvalidateDecodedInstructions(address);
 
-	while (IsRunning())
+	if constexpr (std::is_same_v<ValuePolicy, IntCodeInt64Policy>)
 	{
-		const ExecutionProgress status = ProcessCurrentInstruction();
-		switch(status)
+		if (m_Jit)
 		{
-		case ExecutionProgress::Halt:
-			m_Status = ExecutionStatus::Halted;
-			break;
-		case ExecutionProgress::Pause:
-			m_InstructionPointer = m_InstructionPointer + 1;
-			m_Status = ExecutionStatus::Paused;
-			break;
-		case ExecutionProgress::Jump:
-			continue;
-		case ExecutionProgress::Continue:
-			m_InstructionPointer = m_InstructionPointer + 1;
-			break;
-		default:
-			std::cerr << "Unrecognized ExecutionStatus: " << static_cast<int>(status) << std::endl;
-			m_Status = ExecutionStatus::Halted;
-			break;
+			m_Jit->OnStore(address);
 		}
 	}
 }
 
-IntCodeComputer::ExecutionProgress IntCodeComputer::ProcessCurrentInstruction()
+template<typename ValuePolicy, typename ProfilingPolicy>
+void BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::TryRunCompiledCode(IntCodeAddress jumpSource)
 {
-	const IntCodeValue& instruction = GetCurrentInstruction();
-	if (!IsValueAnInstructionCode(instruction))
+	if constexpr (std::is_same_v<ValuePolicy, IntCodeInt64Policy>)
 	{
-		std::cerr << "Unexpected VALUE is not an INSTRUCTION_CODE: " << instruction << " at position " << m_InstructionPointer << std::endl;
-		return ExecutionProgress::Halt;
+		bool hasWrittenProgram = false;
+		if (m_Jit->TryRun(m_Memory, jumpSource, m_InstructionPointer, m_RelativeBase, hasWrittenProgram) && hasWrittenProgram)
+		{
+			// Compiled code doesn't keep track of what it overwrote
+			m_DecodedInstructions.assign(m_DecodedInstructions.size(), DecodedInstruction());
+		}
+	}
+	else
+	{
+		(void)jumpSource;
 	}
+}
 
-	OpCode opCode = GetCurrentOpCode();
-	const InstructionSet& instructionSet = GetInstructionSet();
-	if (instructionSet.count(opCode) && instructionSet.at(opCode))
+template<typename ValuePolicy, typename ProfilingPolicy>
+bool BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::GetParameterValue(const Operation& instruction, std::size_t index, Value& value) const
+{
+	if (instruction.m_ParameterModes[index] == ParameterMode::IMM)
 	{
-		const InstructionFnc instructionFnc = instructionSet.at(opCode);
-		return (this->*instructionFnc)();
+		value = instruction.m_Parameters[index];
+		return true;
 	}
-	else
+
+	IntCodeAddress address;
+	if (!GetParameterAddress(instruction, index, address))
 	{
-		std::cerr << "Unexpected OPCODE " << instruction << " at position " << m_InstructionPointer << std::endl;
-		return ExecutionProgress::Halt;
+		return false;
+	}
+
+	value = m_Memory.ReadValue(address);
+	return true;
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+bool BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::GetParameterAddress(const Operation& instruction, std::size_t index, IntCodeAddress& address) const
+{
+	const Value& parameter = instruction.m_Parameters[index];
+
+	switch (instruction.m_ParameterModes[index])
+	{
+	case ParameterMode::POS:
+		return ValuePolicy::TryToAddress(parameter, address);
+	case ParameterMode::REL:
+	{
+		Value relativeAddress;
+		return ValuePolicy::TryAdd(parameter, m_RelativeBase, relativeAddress) && ValuePolicy::TryToAddress(relativeAddress, address);
+	}
+	case ParameterMode::IMM:
+		std::cerr << "Cannot write on an Immediate" << std::endl;
+		return false;
+	default:
+		std::cerr << "Unrecognized ParameterMode " << static_cast<int>(instruction.m_ParameterModes[index]) << std::endl;
+		return false;
 	}
 }
 
-IntCodeComputer::ExecutionProgress IntCodeComputer::Add()
+template<typename ValuePolicy, typename ProfilingPolicy>
+BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::BasicIntCodeComputer(IntCodeProgramImagePtr image)
+	: m_Image(std::move(image))
+	, m_OutputChannel(std::make_shared<IntCodeChannel<Value>>())
+	, m_InputChannel(std::make_shared<IntCodeChannel<Value>>())
 {
-	assert(GetCurrentOpCode() == OpCode::ADD);
-	
-	const std::vector<ParameterMode> parameterModes = ExtractParameterModes(GetCurrentInstruction(), 3);
+	if (const auto program = m_Image->GetProgramFor<ValuePolicy>())
+	{
+		m_InitialMemory.Reset(*program);
+	}
 
-	const IntCodeValue in1 = GetValueFromParameterMode(parameterModes[0], GetNextValueAndStepPointer());
-	const IntCodeValue in2 = GetValueFromParameterMode(parameterModes[1], GetNextValueAndStepPointer());
-	const IntCodeAddress out = GetAddressFromParameterMode(parameterModes[2], GetNextValueAndStepPointer());
+	Reset();
+}
 
-	m_Memory.StoreValue(out, in1 + in2);
+template<typename ValuePolicy, typename ProfilingPolicy>
+BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::BasicIntCodeComputer(const std::string& fileName)
+	: BasicIntCodeComputer(IntCodeProgramRegistry::Get().Load(fileName))
+{
+}
 
-	return ExecutionProgress::Continue;
+template<typename ValuePolicy, typename ProfilingPolicy>
+BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::BasicIntCodeComputer(IntCodeProgram program)
+	: BasicIntCodeComputer(IntCodeProgramImage::Create(std::move(program)))
+{
 }
 
-IntCodeComputer::ExecutionProgress IntCodeComputer::Mul()
+template<typename ValuePolicy, typename ProfilingPolicy>
+template<typename SourcePolicy>
+BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::BasicIntCodeComputer(BasicIntCodeComputer<SourcePolicy, ProfilingPolicy>&& other)
+	: m_Image(other.m_Image)
+	, m_InstructionPointer(other.m_InstructionPointer)
+	, m_Status(other.m_Status == ExecutionStatus::Overflowed ? ExecutionStatus::Paused : other.m_Status)
+	, m_PauseOnOutput(other.m_PauseOnOutput)
+	, m_InstructionCount(other.m_InstructionCount)
+	, m_Profiler(std::move(other.m_Profiler))
+	, m_OutputChannel(CopyChannel(*other.m_OutputChannel, [](const auto& value, Value& result) { return ValuePolicy::TryFromBigInt(SourcePolicy::ToBigInt(value), result); }))
+	, m_InputChannel(CopyChannel(*other.m_InputChannel, [](const auto& value, Value& result) { return ValuePolicy::TryFromBigInt(SourcePolicy::ToBigInt(value), result); }))
 {
-	assert(GetCurrentOpCode() == OpCode::MUL);
+	static_assert(ValuePolicy::IsUnbounded || !SourcePolicy::IsUnbounded, "Computers can only be moved into a wider ValuePolicy");
 
-	const std::vector<ParameterMode> parameterModes = ExtractParameterModes(GetCurrentInstruction(), 3);
+	const bool converted = m_InitialMemory.TryConvertFrom(other.m_InitialMemory)
+		&& m_Memory.TryConvertFrom(other.m_Memory)
+		&& ValuePolicy::TryFromBigInt(SourcePolicy::ToBigInt(other.m_RelativeBase), m_RelativeBase);
 
-	const IntCodeValue in1 = GetValueFromParameterMode(parameterModes[0], GetNextValueAndStepPointer());
-	const IntCodeValue in2 = GetValueFromParameterMode(parameterModes[1], GetNextValueAndStepPointer());
-	const IntCodeAddress out = GetAddressFromParameterMode(parameterModes[2], GetNextValueAndStepPointer());
+	assert(converted);
+	(void)converted;
 
-	m_Memory.StoreValue(out, in1 * in2);
+	m_DecodedInstructions.assign(m_Image->GetSize() + MaxInstructionLength - 1, DecodedInstruction());
+}
 
-	return ExecutionProgress::Continue;
+template<typename ValuePolicy, typename ProfilingPolicy>
+BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::BasicIntCodeComputer(BasicIntCodeComputer& parent, ForkTag)
+	: m_Image(parent.m_Image)
+	, m_InitialMemory(parent.m_InitialMemory)
+	, m_Memory(parent.m_Memory)
+	, m_DecodedInstructions(parent.m_DecodedInstructions)
+	, m_InstructionPointer(parent.m_InstructionPointer)
+	, m_RelativeBase(parent.m_RelativeBase)
+	, m_Status(parent.m_Status)
+	, m_PauseOnOutput(parent.m_PauseOnOutput)
+	, m_InstructionCount(parent.m_InstructionCount)
+	, m_Jit(parent.m_Jit ? std::make_shared<IntCodeJit>(*parent.m_Jit) : nullptr)
+	, m_OutputChannel(CopyChannel(*parent.m_OutputChannel, [](const Value& value, Value& result) { result = value; return true; }))
+	, m_InputChannel(CopyChannel(*parent.m_InputChannel, [](const Value& value, Value& result) { result = value; return true; }))
+{
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+BasicIntCodeComputer<ValuePolicy, ProfilingPolicy> BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::Fork()
+{
+	return BasicIntCodeComputer(*this, ForkTag());
 }
 
-IntCodeComputer::ExecutionProgress IntCodeComputer::Input()
+template<typename ValuePolicy, typename ProfilingPolicy>
+void BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::SaveSnapshot(std::ostream& output) const
 {
-	assert(GetCurrentOpCode() == OpCode::IN_);
+	IntCodeSnapshot::WriteHeader(output, { IntCodeSnapshot::GetValueKind<ValuePolicy>(), m_Image->GetHash(), m_Image->GetSize() });
 
-	const std::vector<ParameterMode> parameterModes = ExtractParameterModes(GetCurrentInstruction(), 1);
-	
-	IntCodeValue value;
-	GetInputStream() >> value;
+	IntCodeSnapshot::WriteInteger(output, m_InstructionPointer);
+	IntCodeSnapshot::WriteValues<ValuePolicy>(output, &m_RelativeBase, 1);
+	IntCodeSnapshot::WriteInteger(output, static_cast<std::uint64_t>(m_Status));
+	IntCodeSnapshot::WriteInteger(output, m_InstructionCount);
 
-	IntCodeAddress out = GetAddressFromParameterMode(parameterModes[0], GetNextValueAndStepPointer());
+	for (const IntCodeChannelPtr<Value>& channel : { m_InputChannel, m_OutputChannel })
+	{
+		std::vector<Value> pendingValues;
+		channel->ForEachPending([&](const Value& value) { pendingValues.push_back(value); });
 
-	m_Memory.StoreValue(out, value);
+		IntCodeSnapshot::WriteInteger(output, pendingValues.size());
+		IntCodeSnapshot::WriteValues<ValuePolicy>(output, pendingValues.data(), pendingValues.size());
+	}
 
-	return ExecutionProgress::Continue;
+	m_Memory.WriteSnapshot(output, m_InitialMemory);
 }
 
-IntCodeComputer::ExecutionProgress IntCodeComputer::Output()
+template<typename ValuePolicy, typename ProfilingPolicy>
+bool BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::LoadSnapshot(std::istream& input)
 {
-	assert(GetCurrentOpCode() == OpCode::OU_);
+	IntCodeSnapshot::Header header;
+	if (!IntCodeSnapshot::ReadHeader(input, header))
+	{
+		std::cerr << "Not an IntCode snapshot" << std::endl;
+		return false;
+	}
+
+	return LoadSnapshot(input, header);
+}
 
-	const std::vector<ParameterMode> parameterModes = ExtractParameterModes(GetCurrentInstruction(), 1);
+template<typename ValuePolicy, typename ProfilingPolicy>
+bool BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::LoadSnapshot(std::istream& input, const IntCodeSnapshot::Header& header)
+{
+	if (header.m_ValueKind != IntCodeSnapshot::GetValueKind<ValuePolicy>() || header.m_ImageHash != m_Image->GetHash() || header.m_ImageSize != m_Image->GetSize())
+	{
+		std::cerr << "Snapshot of another program, or of a computer with another ValuePolicy" << std::endl;
+		return false;
+	}
 
-	const IntCodeValue in1 = GetValueFromParameterMode(parameterModes[0], GetNextValueAndStepPointer());
+	Reset();
 
-	GetOutputStream() << in1 << std::endl;
-	
-	return m_PauseOnOutput ? ExecutionProgress::Pause : ExecutionProgress::Continue;
+	const auto readChannel = [&input](IntCodeChannel<Value>& channel)
+	{
+		std::uint64_t count = 0;
+		if (!IntCodeSnapshot::ReadInteger(input, count) || count > channel.GetCapacity())
+		{
+			return false;
+		}
+
+		std::vector<Value> values(count);
+		return IntCodeSnapshot::ReadValues<ValuePolicy>(input, values.data(), values.size()) && channel.Push(values) == values.size();
+	};
+
+	std::uint64_t instructionPointer = 0, status = 0, instructionCount = 0;
+	const bool isValid = IntCodeSnapshot::ReadInteger(input, instructionPointer)
+		&& IntCodeSnapshot::ReadValues<ValuePolicy>(input, &m_RelativeBase, 1)
+		&& IntCodeSnapshot::ReadInteger(input, status)
+		&& status <= static_cast<std::uint64_t>(ExecutionStatus::Halted)
+		&& IntCodeSnapshot::ReadInteger(input, instructionCount)
+		&& readChannel(*m_InputChannel)
+		&& readChannel(*m_OutputChannel)
+		&& m_Memory.ReadSnapshot(input);
+
+	if (!isValid)
+	{
+		std::cerr << "Invalid IntCode snapshot" << std::endl;
+		Reset();
+		return false;
+	}
+
+	m_InstructionPointer = instructionPointer;
+	m_Status = static_cast<ExecutionStatus>(status);
+	m_InstructionCount = instructionCount;
+
+	if constexpr (std::is_same_v<ValuePolicy, IntCodeInt64Policy>)
+	{
+		if (m_Jit)
+		{
+			m_Jit->Revalidate(m_Memory);
+		}
+	}
+
+	return true;
 }
 
-IntCodeComputer::ExecutionProgress IntCodeComputer::JumpIfTrue()
+template<typename ValuePolicy, typename ProfilingPolicy>
+template<typename SourceValue, typename Conversion>
+IntCodeChannelPtr<typename ValuePolicy::Value> BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::CopyChannel(const IntCodeChannel<SourceValue>& source, Conversion conversion)
 {
-	return InternalJump([](IntCodeValue v) { return v != 0; });
+	auto channel = std::make_shared<IntCodeChannel<Value>>(source.GetCapacity());
+
+	source.ForEachPending([&](const SourceValue& sourceValue)
+	{
+		Value value;
+		const bool converted = conversion(sourceValue, value);
+		assert(converted);
+		(void)converted;
+
+		channel->TryPush(std::move(value));
+	});
+
+	return channel;
 }
 
-IntCodeComputer::ExecutionProgress IntCodeComputer::JumpIfFalse()
+template<typename ValuePolicy, typename ProfilingPolicy>
+IntCodeCoroutine<typename ValuePolicy::Value> BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::Run()
 {
-	return InternalJump([](IntCodeValue v) { return v == 0; });
+	return RunAsCoroutine<Value>(*this);
 }
 
-template<typename IntCodeTest>
-IntCodeComputer::ExecutionProgress IntCodeComputer::InternalJump(IntCodeTest test)
+template<typename ValuePolicy, typename ProfilingPolicy>
+void BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::SetExecutionState(IntCodeAddress instructionPointer, Value relativeBase)
 {
-	OpCode opCode = GetCurrentOpCode();
-	assert( opCode == OpCode::JF_ || opCode == OpCode::JT_ );
-
-	const std::vector<ParameterMode> parameterModes = ExtractParameterModes(GetCurrentInstruction(), 2);
-
-	const IntCodeValue in1 = GetValueFromParameterMode(parameterModes[0], GetNextValueAndStepPointer());
-	const IntCodeValue in2 = GetValueFromParameterMode(parameterModes[1], GetNextValueAndStepPointer());
+	m_InstructionPointer = instructionPointer;
+	m_RelativeBase = std::move(relativeBase);
+	m_Status = ExecutionStatus::Paused;
+}
 
-	if (test(in1))
+template<typename ValuePolicy, typename ProfilingPolicy>
+void BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::SetJitEnabled(bool isEnabled)
+{
+	if constexpr (std::is_same_v<ValuePolicy, IntCodeInt64Policy> && IntCodeJit::IsSupported() && !ProfilingPolicy::IsEnabled)
 	{
-		m_InstructionPointer = in2;
-		return ExecutionProgress::Jump;
+		if (!isEnabled)
+		{
+			m_Jit.reset();
+		}
+		else if (!m_Jit)
+		{
+			m_Jit = std::make_shared<IntCodeJit>(m_DecodedInstructions.size());
+		}
 	}
 	else
 	{
-		return ExecutionProgress::Continue;
+		(void)isEnabled;
 	}
 }
 
-IntCodeComputer::ExecutionProgress IntCodeComputer::LessThan()
+template<typename ValuePolicy, typename ProfilingPolicy>
+void BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::SetNounAndVerb(InitData initData)
 {
-	return InternalCompare([](IntCodeValue v1, IntCodeValue v2) { return v1 < v2;  });
-}
+	Value noun, verb;
+	if (!ValuePolicy::TryFromBigInt(initData.noun, noun) || !ValuePolicy::TryFromBigInt(initData.verb, verb))
+	{
+		std::cerr << "Noun " << initData.noun << " and Verb " << initData.verb << " don't fit in this computer" << std::endl;
+		return;
+	}
 
-IntCodeComputer::ExecutionProgress IntCodeComputer::Equals()
-{
-	return InternalCompare([](IntCodeValue v1, IntCodeValue v2) { return v1 == v2; });
+	StoreValue(1, std::move(noun));
+	StoreValue(2, std::move(verb));
 }
 
-template<typename IntCodeComparison>
-IntCodeComputer::ExecutionProgress IntCodeComputer::InternalCompare(IntCodeComparison comparison)
+template<typename ValuePolicy, typename ProfilingPolicy>
+void BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::Reset()
 {
-	OpCode opCode = GetCurrentOpCode();
-	assert( opCode == OpCode::LT_ || opCode == OpCode::EQU );
+	m_Memory = m_InitialMemory;
+	m_InstructionPointer = 0;
+	m_RelativeBase = 0;
+	m_Status = ExecutionStatus::NotStarted;
+	m_InstructionCount = 0;
 
-	std::vector<ParameterMode> parameterModes = ExtractParameterModes(GetCurrentInstruction(), 3);
+	m_DecodedInstructions.assign(m_Image->GetSize() + MaxInstructionLength - 1, DecodedInstruction());
 
-	const IntCodeValue in1 = GetValueFromParameterMode(parameterModes[0], GetNextValueAndStepPointer());
-	const IntCodeValue in2 = GetValueFromParameterMode(parameterModes[1], GetNextValueAndStepPointer());
-	const IntCodeAddress out = GetAddressFromParameterMode(parameterModes[2], GetNextValueAndStepPointer());
+	if constexpr (std::is_same_v<ValuePolicy, IntCodeInt64Policy>)
+	{
+		if (m_Jit)
+		{
+			m_Jit->Revalidate(m_Memory);
+		}
+	}
 
-	m_Memory.StoreValue(out, comparison(in1, in2) ? 1 : 0);
-	
-	return ExecutionProgress::Continue;
+	m_InputChannel->Clear();
+	m_OutputChannel->Clear();
 }
 
-IntCodeComputer::ExecutionProgress IntCodeComputer::Rebase()
+template<typename ValuePolicy, typename ProfilingPolicy>
+void BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::Execute(std::uint64_t maxInstructions)
 {
-	assert(GetCurrentOpCode() == OpCode::RBS);
+	m_Status = ExecutionStatus::Running;
+
+	const bool isLimited = maxInstructions != UnlimitedInstructions;
+	const std::uint64_t instructionLimit = m_InstructionCount + std::min(maxInstructions, UnlimitedInstructions - m_InstructionCount);
+
+	while (IsRunning())
+	{
+		if (m_InstructionCount >= instructionLimit)
+		{
+			m_Status = ExecutionStatus::Preempted;
+			break;
+		}
 
-	std::vector<ParameterMode> parameterModes = ExtractParameterModes(GetCurrentInstruction(), 1);
-	const IntCodeValue in = GetValueFromParameterMode(parameterModes[0], GetNextValueAndStepPointer());
+		const IntCodeAddress instructionAddress = m_InstructionPointer;
+		const DecodedInstruction& instruction = FetchCurrentInstruction();
+
+		if (!m_WatchedCells.empty() && IsAccessingWatchedCells(instructionAddress, instruction))
+		{
+			m_Status = ExecutionStatus::Paused;
+			break;
+		}
 
-	m_RelativeBase = m_RelativeBase + static_cast<IntCodeAddress>(in);
+		// The instruction might overwrite itself, which invalidates it: keep what's needed afterwards
+		const std::uint8_t instructionLength = instruction.m_Length;
+		const bool isValidInstruction = instruction.m_State == DecodedInstruction::State::Valid;
+		const OpCode opCode = instruction.m_OpCode;
 
-	return ExecutionProgress::Continue;
-}
\ No newline at end of file
+		ExecutionProgress status;
+		if (instruction.m_Superinstruction != Superinstruction::None)
+		{
+			status = ExecuteSuperinstruction(instruction);
+		}
+		else switch (isValidInstruction ? opCode : OpCode::HLT)
+		{
+		case OpCode::ADD: status = Add(instruction); break;
+		case OpCode::MUL: status = Mul(instruction); break;
+		case OpCode::IN_: status = Input(instruction); break;
+		case OpCode::OU_: status = Output(instruction); break;
+		case OpCode::JT_: status = JumpIfTrue(instruction); break;
+		case OpCode::JF_: status = JumpIfFalse(instruction); break;
+		case OpCode::LT_: status = LessThan(instruction); break;
+		case OpCode::EQU: status = Equals(instruction); break;
+		case OpCode::RBS: status = Rebase(instruction); break;
+		case OpCode::HLT:
+		default:
+			status = isValidInstruction ? ExecutionProgress::Halt : InvalidInstruction(instruction);
+			break;
+		}
+
+		if constexpr (ProfilingPolicy::IsEnabled)
+		{
+			if (isValidInstruction)
+			{
+				Profile(instructionAddress, opCode, status);
+			}
+		}
+
+		switch(status)
+		{
+		case ExecutionProgress::Halt:
+			m_InstructionCount++;
+			m_Status = ExecutionStatus::Halted;
+			break;
+		case ExecutionProgress::Pause:
+			m_InstructionCount++;
+			m_InstructionPointer += instructionLength;
+			m_Status = ExecutionStatus::Paused;
+			break;
+		case ExecutionProgress::Block:
+			m_Status = ExecutionStatus::Paused;
+			break;
+		case ExecutionProgress::AwaitInput:
+			m_Status = ExecutionStatus::AwaitingInput;
+			break;
+		case ExecutionProgress::Overflow:
+			m_Status = ExecutionStatus::Overflowed;
+			break;
+		case ExecutionProgress::Jump:
+			m_InstructionCount++;
+			if (m_Jit && m_WatchedCells.empty() && !isLimited)
+			{
+				TryRunCompiledCode(instructionAddress);
+			}
+			continue;
+		case ExecutionProgress::Continue:
+			m_InstructionCount++;
+			m_InstructionPointer += instructionLength;
+			break;
+		default:
+			std::cerr << "Unrecognized ExecutionStatus: " << static_cast<int>(status) << std::endl;
+			m_Status = ExecutionStatus::Halted;
+			break;
+		}
+	}
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+void BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecuteUntil(std::chrono::steady_clock::time_point deadline)
+{
+	do
+	{
+		Execute(DeadlineSliceInstructions);
+	} while (IsPreempted() && std::chrono::steady_clock::now() < deadline);
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+void BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecuteUntilAccess(std::span<const IntCodeAddress> cells)
+{
+	// Superinstructions would hide their second half from the watch
+	m_WatchedCells.assign(cells.begin(), cells.end());
+	m_DecodedInstructions.assign(m_DecodedInstructions.size(), DecodedInstruction());
+
+	Execute();
+
+	m_WatchedCells.clear();
+	m_DecodedInstructions.assign(m_DecodedInstructions.size(), DecodedInstruction());
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+bool BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::IsAccessingWatchedCells(IntCodeAddress address, const DecodedInstruction& instruction) const
+{
+	const auto isWatched = [this](IntCodeAddress cell) { return std::find(m_WatchedCells.begin(), m_WatchedCells.end(), cell) != m_WatchedCells.end(); };
+
+	for (IntCodeAddress cell = address; cell < address + instruction.m_Length; cell++)
+	{
+		if (isWatched(cell))
+		{
+			return true;
+		}
+	}
+
+	if (instruction.m_State != DecodedInstruction::State::Valid)
+	{
+		return false;
+	}
+
+	for (std::size_t i = 0; i < GetParameterCount(instruction.m_OpCode); i++)
+	{
+		IntCodeAddress cell;
+		if (instruction.m_ParameterModes[i] != ParameterMode::IMM && GetParameterAddress(instruction, i, cell) && isWatched(cell))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+void BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::Profile(IntCodeAddress address, OpCode opCode, ExecutionProgress status)
+{
+	if constexpr (ProfilingPolicy::IsEnabled)
+	{
+		switch (status)
+		{
+		case ExecutionProgress::AwaitInput:
+			m_Profiler.OnInputWait(address);
+			return;
+		case ExecutionProgress::Block:
+			m_Profiler.OnOutputWait(address);
+			return;
+		case ExecutionProgress::Overflow:
+			// Runs again on the wider computer, which counts it
+			return;
+		default:
+			break;
+		}
+
+		m_Profiler.OnInstruction(address, opCode);
+		if (opCode == OpCode::JT_ || opCode == OpCode::JF_)
+		{
+			m_Profiler.OnBranch(address, status == ExecutionProgress::Jump);
+		}
+	}
+	else
+	{
+		(void)address;
+		(void)opCode;
+		(void)status;
+	}
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecutionProgress BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::InvalidInstruction(const DecodedInstruction& instruction)
+{
+	assert(instruction.m_State == DecodedInstruction::State::Invalid);
+	(void)instruction;
+
+	std::cerr << "Unexpected VALUE is not an INSTRUCTION_CODE: " << GetValueAt(m_InstructionPointer) << " at position " << m_InstructionPointer << std::endl;
+	return ExecutionProgress::Halt;
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecutionProgress BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::Dispatch(const Operation& instruction)
+{
+	switch (instruction.m_OpCode)
+	{
+	case OpCode::ADD: return Add(instruction);
+	case OpCode::MUL: return Mul(instruction);
+	case OpCode::JT_: return JumpIfTrue(instruction);
+	case OpCode::JF_: return JumpIfFalse(instruction);
+	case OpCode::LT_: return LessThan(instruction);
+	case OpCode::EQU: return Equals(instruction);
+	case OpCode::RBS: return Rebase(instruction);
+	default:
+		std::cerr << "Unexpected OpCode " << static_cast<int>(instruction.m_OpCode) << " in a superinstruction" << std::endl;
+		return ExecutionProgress::Halt;
+	}
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecutionProgress BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecuteSuperinstruction(const DecodedInstruction& instruction)
+{
+	const IntCodeAddress nextAddress = m_InstructionPointer + instruction.m_FirstLength;
+	bool isTaken = false;
+
+	auto&& [in1, in2, target] = GetOperands();
+
+	if (instruction.m_Superinstruction == Superinstruction::CompareAndBranch)
+	{
+		IntCodeAddress out;
+		if (!GetParameterValue(instruction, 0, in1) || !GetParameterValue(instruction, 1, in2) || !GetParameterAddress(instruction, 2, out))
+		{
+			return InvalidAddress();
+		}
+
+		// The cell is written all the same: nothing tells it isn't read anywhere else
+		const bool result = instruction.m_OpCode == OpCode::LT_ ? in1 < in2 : in1 == in2;
+		StoreValue(out, result ? 1 : 0);
+		isTaken = result == (instruction.m_Next.m_OpCode == OpCode::JT_);
+	}
+	else
+	{
+		const ExecutionProgress status = Dispatch(instruction);
+		if (status != ExecutionProgress::Continue)
+		{
+			return status;
+		}
+	}
+
+	// The first instruction wrote over the second one, which is now stale
+	if (instruction.m_State != DecodedInstruction::State::Valid)
+	{
+		m_InstructionPointer = nextAddress;
+		return ExecutionProgress::Jump;
+	}
+
+	// The first instruction is done, Execute counts the second one as it counts any other
+	m_InstructionCount++;
+
+	if (instruction.m_Superinstruction == Superinstruction::CompareAndBranch)
+	{
+		if (!isTaken)
+		{
+			return ExecutionProgress::Continue;
+		}
+
+		if (!GetParameterValue(instruction.m_Next, 1, target) || !ValuePolicy::TryToAddress(target, m_InstructionPointer))
+		{
+			m_InstructionPointer = nextAddress;
+			return InvalidAddress();
+		}
+
+		return ExecutionProgress::Jump;
+	}
+
+	// Whatever happens from here, it happens to the second instruction
+	const IntCodeAddress firstAddress = m_InstructionPointer;
+	m_InstructionPointer = nextAddress;
+
+	const ExecutionProgress status = Dispatch(instruction.m_Next);
+	if (status == ExecutionProgress::Continue)
+	{
+		m_InstructionPointer = firstAddress;
+	}
+
+	return status;
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecutionProgress BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::InvalidAddress()
+{
+	std::cerr << "Invalid address used by instruction at position " << m_InstructionPointer << std::endl;
+	return ExecutionProgress::Halt;
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecutionProgress BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::Add(const Operation& instruction)
+{
+	assert(instruction.m_OpCode == OpCode::ADD);
+	return InternalArithmetic(instruction, &ValuePolicy::TryAdd);
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecutionProgress BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::Mul(const Operation& instruction)
+{
+	assert(instruction.m_OpCode == OpCode::MUL);
+	return InternalArithmetic(instruction, &ValuePolicy::TryMul);
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+template<typename IntCodeOperation>
+typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecutionProgress BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::InternalArithmetic(const Operation& instruction, IntCodeOperation operation)
+{
+	auto&& [in1, in2, result] = GetOperands();
+
+	IntCodeAddress out;
+	if (!GetParameterValue(instruction, 0, in1) || !GetParameterValue(instruction, 1, in2) || !GetParameterAddress(instruction, 2, out))
+	{
+		return InvalidAddress();
+	}
+
+	if (!operation(in1, in2, result))
+	{
+		return ExecutionProgress::Overflow;
+	}
+
+	SwapValue(out, result);
+
+	return ExecutionProgress::Continue;
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecutionProgress BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::Input(const Operation& instruction)
+{
+	assert(instruction.m_OpCode == OpCode::IN_);
+
+	IntCodeAddress out;
+	if (!GetParameterAddress(instruction, 0, out))
+	{
+		return InvalidAddress();
+	}
+
+	Value value;
+	if (!m_InputChannel->TryPop(value))
+	{
+		return ExecutionProgress::AwaitInput;
+	}
+
+	StoreValue(out, std::move(value));
+
+	return ExecutionProgress::Continue;
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecutionProgress BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::Output(const Operation& instruction)
+{
+	assert(instruction.m_OpCode == OpCode::OU_);
+
+	auto&& operands = GetOperands();
+	Value& in1 = operands[0];
+
+	if (!GetParameterValue(instruction, 0, in1))
+	{
+		return InvalidAddress();
+	}
+
+	if (!m_OutputChannel->TryPush(std::move(in1)))
+	{
+		return ExecutionProgress::Block;
+	}
+
+	return m_PauseOnOutput ? ExecutionProgress::Pause : ExecutionProgress::Continue;
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecutionProgress BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::JumpIfTrue(const Operation& instruction)
+{
+	assert(instruction.m_OpCode == OpCode::JT_);
+	return InternalJump(instruction, [](const Value& v) { return v != 0; });
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecutionProgress BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::JumpIfFalse(const Operation& instruction)
+{
+	assert(instruction.m_OpCode == OpCode::JF_);
+	return InternalJump(instruction, [](const Value& v) { return v == 0; });
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+template<typename IntCodeTest>
+typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecutionProgress BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::InternalJump(const Operation& instruction, IntCodeTest test)
+{
+	auto&& operands = GetOperands();
+	Value& in1 = operands[0];
+	Value& in2 = operands[1];
+
+	if (!GetParameterValue(instruction, 0, in1) || !GetParameterValue(instruction, 1, in2))
+	{
+		return InvalidAddress();
+	}
+
+	if (test(in1))
+	{
+		if (!ValuePolicy::TryToAddress(in2, m_InstructionPointer))
+		{
+			return InvalidAddress();
+		}
+
+		return ExecutionProgress::Jump;
+	}
+	else
+	{
+		return ExecutionProgress::Continue;
+	}
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecutionProgress BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::LessThan(const Operation& instruction)
+{
+	assert(instruction.m_OpCode == OpCode::LT_);
+	return InternalCompare(instruction, [](const Value& v1, const Value& v2) { return v1 < v2;  });
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecutionProgress BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::Equals(const Operation& instruction)
+{
+	assert(instruction.m_OpCode == OpCode::EQU);
+	return InternalCompare(instruction, [](const Value& v1, const Value& v2) { return v1 == v2; });
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+template<typename IntCodeComparison>
+typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecutionProgress BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::InternalCompare(const Operation& instruction, IntCodeComparison comparison)
+{
+	auto&& operands = GetOperands();
+	Value& in1 = operands[0];
+	Value& in2 = operands[1];
+
+	IntCodeAddress out;
+	if (!GetParameterValue(instruction, 0, in1) || !GetParameterValue(instruction, 1, in2) || !GetParameterAddress(instruction, 2, out))
+	{
+		return InvalidAddress();
+	}
+
+	StoreValue(out, comparison(in1, in2) ? 1 : 0);
+
+	return ExecutionProgress::Continue;
+}
+
+template<typename ValuePolicy, typename ProfilingPolicy>
+typename BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::ExecutionProgress BasicIntCodeComputer<ValuePolicy, ProfilingPolicy>::Rebase(const Operation& instruction)
+{
+	assert(instruction.m_OpCode == OpCode::RBS);
+
+	auto&& operands = GetOperands();
+	Value& in = operands[0];
+
+	if (!GetParameterValue(instruction, 0, in))
+	{
+		return InvalidAddress();
+	}
+
+	if (!ValuePolicy::TryAdd(m_RelativeBase, in, m_RelativeBase))
+	{
+		return ExecutionProgress::Overflow;
+	}
+
+	return ExecutionProgress::Continue;
+}
+
+template class IntCodeMemory<IntCodeInt64Policy>;
+template class IntCodeMemory<IntCodeBigIntPolicy>;
+template class BasicIntCodeComputer<IntCodeInt64Policy>;
+template class BasicIntCodeComputer<IntCodeBigIntPolicy>;
+template BasicIntCodeComputer<IntCodeBigIntPolicy>::BasicIntCodeComputer(BasicIntCodeComputer<IntCodeInt64Policy>&&);
+template class BasicIntCodeComputer<IntCodeInt64Policy, IntCodeProfiler>;
+template class BasicIntCodeComputer<IntCodeBigIntPolicy, IntCodeProfiler>;
+template BasicIntCodeComputer<IntCodeBigIntPolicy, IntCodeProfiler>::BasicIntCodeComputer(BasicIntCodeComputer<IntCodeInt64Policy, IntCodeProfiler>&&);
+
+#if INTCODE_HAS_INT128
+template class IntCodeMemory<IntCodeInt128Policy>;
+template class BasicIntCodeComputer<IntCodeInt128Policy>;
+template BasicIntCodeComputer<IntCodeInt128Policy>::BasicIntCodeComputer(BasicIntCodeComputer<IntCodeInt64Policy>&&);
+template BasicIntCodeComputer<IntCodeBigIntPolicy>::BasicIntCodeComputer(BasicIntCodeComputer<IntCodeInt128Policy>&&);
+#endif
+
+template<typename ProfilingPolicy>
+typename PromotingIntCodeComputer<ProfilingPolicy>::ComputerVariant PromotingIntCodeComputer<ProfilingPolicy>::MakeComputer(IntCodeProgramImagePtr image)
+{
+	if (image->IsEmpty() || image->GetProgramFor<IntCodeInt64Policy>())
+	{
+		return FastComputer(std::move(image));
+	}
+
+	return BigComputer(std::move(image));
+}
+
+template<typename ProfilingPolicy>
+PromotingIntCodeComputer<ProfilingPolicy>::PromotingIntCodeComputer(IntCodeProgramImagePtr image)
+	: m_Computer(MakeComputer(std::move(image)))
+{
+	if (IntCodeTraceRecorder::Get().IsEnabled())
+	{
+		m_Trace = IntCodeTraceRecorder::Get().CreateTrace(IntCodeTrace(GetImage()->GetHash(), GetImage()->GetSize()));
+	}
+}
+
+template<typename ProfilingPolicy>
+PromotingIntCodeComputer<ProfilingPolicy>::PromotingIntCodeComputer(const std::string& fileName)
+	: PromotingIntCodeComputer(IntCodeProgramRegistry::Get().Load(fileName))
+{
+}
+
+template<typename ProfilingPolicy>
+PromotingIntCodeComputer<ProfilingPolicy>::PromotingIntCodeComputer(IntCodeProgram program)
+	: PromotingIntCodeComputer(IntCodeProgramImage::Create(std::move(program)))
+{
+}
+
+template<typename ProfilingPolicy>
+PromotingIntCodeComputer<ProfilingPolicy>::PromotingIntCodeComputer(ComputerVariant computer, bool pauseOnOutput)
+	: m_Computer(std::move(computer))
+	, m_PauseOnOutput(pauseOnOutput)
+{
+}
+
+template<typename ProfilingPolicy>
+void PromotingIntCodeComputer<ProfilingPolicy>::SetNounAndVerb(InitData initData)
+{
+	IntCodeInt64Policy::Value unused;
+	if (!IntCodeInt64Policy::TryFromBigInt(initData.noun, unused) || !IntCodeInt64Policy::TryFromBigInt(initData.verb, unused))
+	{
+		Promote();
+	}
+
+	std::visit([&](auto& computer) { computer.SetNounAndVerb(initData); }, m_Computer);
+
+	RecordEvent(IntCodeTrace::EventKind::Store, 1, initData.noun);
+	RecordEvent(IntCodeTrace::EventKind::Store, 2, initData.verb);
+}
+
+template<typename ProfilingPolicy>
+void PromotingIntCodeComputer<ProfilingPolicy>::Reset()
+{
+	if (BigComputer* bigComputer = std::get_if<BigComputer>(&m_Computer))
+	{
+		// Give the fast path another chance, the overflow might have been input-dependant
+		ProfilingPolicy profiler = std::move(bigComputer->GetProfiler());
+		m_Computer = MakeComputer(bigComputer->GetImage());
+		SetPauseOnOutput(m_PauseOnOutput);
+		SetJitEnabled(m_IsJitEnabled);
+		GetProfiler() = std::move(profiler);
+	}
+	else
+	{
+		std::visit([](auto& computer) { computer.Reset(); }, m_Computer);
+	}
+
+	RecordEvent(IntCodeTrace::EventKind::Reset);
+}
+
+template<typename ProfilingPolicy>
+void PromotingIntCodeComputer<ProfilingPolicy>::Execute(std::uint64_t maxInstructions)
+{
+	const std::uint64_t firstInstruction = GetInstructionCount();
+	std::visit([&](auto& computer) { computer.Execute(maxInstructions); }, m_Computer);
+
+	const FastComputer* fastComputer = std::get_if<FastComputer>(&m_Computer);
+	if (fastComputer && fastComputer->IsOverflowed())
+	{
+		Promote();
+
+		const std::uint64_t executedInstructions = GetInstructionCount() - firstInstruction;
+		const bool isLimited = maxInstructions != UnlimitedInstructions;
+		std::get<BigComputer>(m_Computer).Execute(isLimited ? maxInstructions - std::min(maxInstructions, executedInstructions) : UnlimitedInstructions);
+	}
+
+	RecordEvent(IntCodeTrace::EventKind::Execute, maxInstructions);
+}
+
+template<typename ProfilingPolicy>
+void PromotingIntCodeComputer<ProfilingPolicy>::ExecuteUntil(std::chrono::steady_clock::time_point deadline)
+{
+	do
+	{
+		Execute(FastComputer::DeadlineSliceInstructions);
+	} while (IsPreempted() && std::chrono::steady_clock::now() < deadline);
+}
+
+template<typename ProfilingPolicy>
+void PromotingIntCodeComputer<ProfilingPolicy>::ExecuteUntilAccess(std::span<const IntCodeAddress> cells)
+{
+	std::visit([&](auto& computer) { computer.ExecuteUntilAccess(cells); }, m_Computer);
+
+	const FastComputer* fastComputer = std::get_if<FastComputer>(&m_Computer);
+	if (fastComputer && fastComputer->IsOverflowed())
+	{
+		Promote();
+		std::get<BigComputer>(m_Computer).ExecuteUntilAccess(cells);
+	}
+
+	for (IntCodeAddress cell : cells)
+	{
+		RecordEvent(IntCodeTrace::EventKind::Watch, cell);
+	}
+	RecordEvent(IntCodeTrace::EventKind::ExecuteUntilAccess);
+}
+
+template<typename ProfilingPolicy>
+void PromotingIntCodeComputer<ProfilingPolicy>::SaveSnapshot(std::ostream& output) const
+{
+	std::visit([&](const auto& computer) { computer.SaveSnapshot(output); }, m_Computer);
+}
+
+template<typename ProfilingPolicy>
+bool PromotingIntCodeComputer<ProfilingPolicy>::LoadSnapshot(std::istream& input)
+{
+	// Nothing the trace holds leads to the snapshot's state
+	m_Trace.reset();
+
+	IntCodeSnapshot::Header header;
+	if (!IntCodeSnapshot::ReadHeader(input, header))
+	{
+		std::cerr << "Not an IntCode snapshot" << std::endl;
+		return false;
+	}
+
+	if (header.m_ValueKind == IntCodeSnapshot::ValueKind::BigInt)
+	{
+		Promote();
+	}
+	else if (IsPromoted())
+	{
+		// Back to 64 bits
+		Reset();
+	}
+
+	return std::visit([&](auto& computer) { return computer.LoadSnapshot(input, header); }, m_Computer);
+}
+
+template<typename ProfilingPolicy>
+IntCodeValue PromotingIntCodeComputer<ProfilingPolicy>::GetValueAt(IntCodeAddress address) const
+{
+	IntCodeValue value = std::visit([&](const auto& computer) { return computer.GetValueAt(address); }, m_Computer);
+	RecordEvent(IntCodeTrace::EventKind::Load, address, value);
+	return value;
+}
+
+template<typename ProfilingPolicy>
+void PromotingIntCodeComputer<ProfilingPolicy>::SetValueAt(IntCodeAddress address, const IntCodeValue& value)
+{
+	RecordEvent(IntCodeTrace::EventKind::Store, address, value);
+
+	if (FastComputer* fastComputer = std::get_if<FastComputer>(&m_Computer))
+	{
+		std::int64_t fastValue;
+		if (IntCodeInt64Policy::TryFromBigInt(value, fastValue))
+		{
+			fastComputer->SetValueAt(address, fastValue);
+			return;
+		}
+
+		Promote();
+	}
+
+	std::get<BigComputer>(m_Computer).SetValueAt(address, value);
+}
+
+template<typename ProfilingPolicy>
+IntCodeCoroutine<IntCodeValue> PromotingIntCodeComputer<ProfilingPolicy>::Run()
+{
+	return RunAsCoroutine<IntCodeValue>(*this);
+}
+
+template<typename ProfilingPolicy>
+void PromotingIntCodeComputer<ProfilingPolicy>::SetExecutionState(IntCodeAddress instructionPointer, const IntCodeValue& relativeBase)
+{
+	RecordEvent(IntCodeTrace::EventKind::SetExecutionState, instructionPointer, relativeBase);
+
+	if (FastComputer* fastComputer = std::get_if<FastComputer>(&m_Computer))
+	{
+		std::int64_t fastRelativeBase;
+		if (IntCodeInt64Policy::TryFromBigInt(relativeBase, fastRelativeBase))
+		{
+			fastComputer->SetExecutionState(instructionPointer, fastRelativeBase);
+			return;
+		}
+
+		Promote();
+	}
+
+	std::get<BigComputer>(m_Computer).SetExecutionState(instructionPointer, relativeBase);
+}
+
+template<typename ProfilingPolicy>
+PromotingIntCodeComputer<ProfilingPolicy> PromotingIntCodeComputer<ProfilingPolicy>::Fork()
+{
+	ComputerVariant child = std::visit([](auto& computer) { return ComputerVariant(computer.Fork()); }, m_Computer);
+	PromotingIntCodeComputer<ProfilingPolicy> fork(std::move(child), m_PauseOnOutput);
+	fork.m_IsJitEnabled = m_IsJitEnabled;
+	if (m_Trace)
+	{
+		// The parent's events are what it takes to get the fork where it starts
+		fork.m_Trace = IntCodeTraceRecorder::Get().CreateTrace(*m_Trace);
+	}
+	return fork;
+}
+
+template<typename ProfilingPolicy>
+std::size_t PromotingIntCodeComputer<ProfilingPolicy>::FeedInputs(std::span<const std::int64_t> inputs)
+{
+	std::size_t fed = 0;
+	if (FastComputer* fastComputer = std::get_if<FastComputer>(&m_Computer))
+	{
+		fed = fastComputer->FeedInputs(inputs);
+	}
+	else
+	{
+		BigComputer& bigComputer = std::get<BigComputer>(m_Computer);
+		while (fed < inputs.size() && bigComputer.GetInputChannel()->TryPush(IntCodeValue(inputs[fed])))
+		{
+			fed++;
+		}
+	}
+
+	if (m_Trace)
+	{
+		for (std::size_t i = 0; i < fed; i++)
+		{
+			RecordEvent(IntCodeTrace::EventKind::Input, 0, inputs[i]);
+		}
+	}
+
+	return fed;
+}
+
+template<typename ProfilingPolicy>
+std::size_t PromotingIntCodeComputer<ProfilingPolicy>::FeedInputs(std::span<const IntCodeValue> inputs)
+{
+	std::size_t fed = 0;
+	if (FastComputer* fastComputer = std::get_if<FastComputer>(&m_Computer))
+	{
+		for (std::int64_t input; fed < inputs.size(); fed++)
+		{
+			if (!IntCodeInt64Policy::TryFromBigInt(inputs[fed], input))
+			{
+				Promote();
+				fed += std::get<BigComputer>(m_Computer).FeedInputs(inputs.subspan(fed));
+				break;
+			}
+
+			if (!fastComputer->GetInputChannel()->TryPush(input))
+			{
+				break;
+			}
+		}
+	}
+	else
+	{
+		fed = std::get<BigComputer>(m_Computer).FeedInputs(inputs);
+	}
+
+	if (m_Trace)
+	{
+		for (std::size_t i = 0; i < fed; i++)
+		{
+			RecordEvent(IntCodeTrace::EventKind::Input, 0, inputs[i]);
+		}
+	}
+
+	return fed;
+}
+
+template<typename ProfilingPolicy>
+std::size_t PromotingIntCodeComputer<ProfilingPolicy>::DrainOutputs(std::span<std::int64_t> outputs)
+{
+	std::size_t drained = 0;
+	if (FastComputer* fastComputer = std::get_if<FastComputer>(&m_Computer))
+	{
+		drained = fastComputer->DrainOutputs(outputs);
+	}
+	else
+	{
+		IntCodeChannel<IntCodeValue>& channel = *std::get<BigComputer>(m_Computer).GetOutputChannel();
+		for (const IntCodeValue* output = channel.Front(); drained < outputs.size() && output != nullptr; output = channel.Front())
+		{
+			if (!IntCodeInt64Policy::TryFromBigInt(*output, outputs[drained]))
+			{
+				break;
+			}
+
+			channel.PopFront();
+			drained++;
+		}
+	}
+
+	if (m_Trace)
+	{
+		for (std::size_t i = 0; i < drained; i++)
+		{
+			RecordEvent(IntCodeTrace::EventKind::Output, 0, outputs[i]);
+		}
+	}
+
+	return drained;
+}
+
+template<typename ProfilingPolicy>
+std::size_t PromotingIntCodeComputer<ProfilingPolicy>::DrainOutputs(std::span<IntCodeValue> outputs)
+{
+	std::size_t drained = 0;
+	if (FastComputer* fastComputer = std::get_if<FastComputer>(&m_Computer))
+	{
+		std::int64_t output;
+		while (drained < outputs.size() && fastComputer->GetOutputChannel()->TryPop(output))
+		{
+			outputs[drained++] = output;
+		}
+	}
+	else
+	{
+		drained = std::get<BigComputer>(m_Computer).DrainOutputs(outputs);
+	}
+
+	if (m_Trace)
+	{
+		for (std::size_t i = 0; i < drained; i++)
+		{
+			RecordEvent(IntCodeTrace::EventKind::Output, 0, outputs[i]);
+		}
+	}
+
+	return drained;
+}
+
+template<typename ProfilingPolicy>
+void PromotingIntCodeComputer<ProfilingPolicy>::SetPauseOnOutput(bool pauseOnOutput)
+{
+	m_PauseOnOutput = pauseOnOutput;
+	std::visit([=](auto& computer) { computer.SetPauseOnOutput(pauseOnOutput); }, m_Computer);
+
+	RecordEvent(IntCodeTrace::EventKind::PauseOnOutput, pauseOnOutput);
+}
+
+template<typename ProfilingPolicy>
+void PromotingIntCodeComputer<ProfilingPolicy>::SetJitEnabled(bool isEnabled)
+{
+	m_IsJitEnabled = isEnabled;
+	std::visit([=, this](auto& computer) { computer.SetJitEnabled(isEnabled && !m_Trace); }, m_Computer);
+}
+
+template<typename ProfilingPolicy>
+void PromotingIntCodeComputer<ProfilingPolicy>::SetTrace(IntCodeTracePtr trace)
+{
+	m_Trace = std::move(trace);
+	SetJitEnabled(m_IsJitEnabled);
+}
+
+template<typename ProfilingPolicy>
+void PromotingIntCodeComputer<ProfilingPolicy>::Promote()
+{
+	if (FastComputer* fastComputer = std::get_if<FastComputer>(&m_Computer))
+	{
+		BigComputer bigComputer(std::move(*fastComputer));
+		m_Computer = std::move(bigComputer);
+	}
+}
+
+template class PromotingIntCodeComputer<IntCodeNoProfiling>;
+template class PromotingIntCodeComputer<IntCodeProfiler>;
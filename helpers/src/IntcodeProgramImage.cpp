@@ -0,0 +1,121 @@
+#include <IntcodeProgramImage.h>
+
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	// FNV-1a, good enough to tell programs apart and trivially stable
+	constexpr std::uint64_t FnvOffsetBasis = 14695981039346656037ull;
+	constexpr std::uint64_t FnvPrime = 1099511628211ull;
+
+	std::uint64_t HashBytes(const char* data, std::size_t size, std::uint64_t hash = FnvOffsetBasis)
+	{
+		for (std::size_t i = 0; i < size; i++)
+		{
+			hash ^= static_cast<unsigned char>(data[i]);
+			hash *= FnvPrime;
+		}
+
+		return hash;
+	}
+}
+
+IntCodeProgramImagePtr IntCodeProgramImage::Create(IntCodeProgram program)
+{
+	std::shared_ptr<IntCodeProgramImage> image(new IntCodeProgramImage());
+
+	image->m_Hash = ComputeHash(program);
+
+	auto int64Program = std::make_shared<std::vector<std::int64_t>>(program.size());
+	bool fitsInInt64 = true;
+	for (std::size_t i = 0; i < program.size() && fitsInInt64; i++)
+	{
+		fitsInInt64 = IntCodeInt64Policy::TryFromBigInt(program[i], (*int64Program)[i]);
+	}
+
+	if (fitsInInt64)
+	{
+		image->m_Int64Program = std::move(int64Program);
+	}
+
+	image->m_Program = std::make_shared<const IntCodeProgram>(std::move(program));
+
+	return image;
+}
+
+IntCodeProgram IntCodeProgramImage::Parse(const std::string& programText)
+{
+	IntCodeProgram program;
+
+	std::stringstream programStream(programText);
+	std::string programLine;
+	while (std::getline(programStream, programLine))
+	{
+		std::stringstream programStringStream(programLine);
+		std::string intCodeValueString;
+		while (std::getline(programStringStream, intCodeValueString, ','))
+		{
+			program.emplace_back(intCodeValueString);
+		}
+	}
+
+	return program;
+}
+
+std::uint64_t IntCodeProgramImage::ComputeHash(const IntCodeProgram& program)
+{
+	// Hash the canonical decimal form, so that the hash doesn't depend on the limb layout
+	std::uint64_t hash = FnvOffsetBasis;
+	for (const IntCodeValue& value : program)
+	{
+		const std::string valueString = value.str();
+		hash = HashBytes(valueString.data(), valueString.size(), hash);
+		hash = HashBytes(",", 1, hash);
+	}
+
+	return hash;
+}
+
+IntCodeProgramRegistry& IntCodeProgramRegistry::Get()
+{
+	static IntCodeProgramRegistry ms_Registry;
+	return ms_Registry;
+}
+
+IntCodeProgramImagePtr IntCodeProgramRegistry::Load(const std::string& filename)
+{
+	std::string fileContent;
+
+	std::ifstream input(filename, std::ios::binary);
+	if (input.is_open())
+	{
+		std::stringstream contentStream;
+		contentStream << input.rdbuf();
+		fileContent = contentStream.str();
+	}
+
+	const std::uint64_t fileHash = HashBytes(fileContent.data(), fileContent.size());
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto it = m_Images.find(filename);
+		if (it != m_Images.end() && it->second.m_FileHash == fileHash)
+		{
+			return it->second.m_Image;
+		}
+	}
+
+	// Parse outside of the lock, worst case two threads parse the same file once each
+	IntCodeProgramImagePtr image = IntCodeProgramImage::Create(IntCodeProgramImage::Parse(fileContent));
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Images[filename] = { fileHash, image };
+	return image;
+}
+
+void IntCodeProgramRegistry::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Images.clear();
+}
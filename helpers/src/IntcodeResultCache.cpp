@@ -0,0 +1,165 @@
+#include <IntcodeResultCache.h>
+#include <IntcodeSnapshot.h>
+#include <IntcodeTrace.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+namespace
+{
+	// "ICRESULT" and the format version
+	constexpr std::uint64_t Magic = 0x4943'5245'5355'4C01ull;
+	constexpr std::uint64_t ByteOrderMark = 0x0102'0304'0506'0708ull;
+
+	// One value at a time: a corrupted count only gets as far as the end of the file
+	bool ReadValues(std::istream& input, std::vector<IntCodeValue>& values)
+	{
+		std::uint64_t count = 0;
+		if (!IntCodeSnapshot::ReadInteger(input, count))
+		{
+			return false;
+		}
+
+		values.clear();
+		for (std::uint64_t i = 0; i < count; i++)
+		{
+			IntCodeValue value;
+			if (!IntCodeSnapshot::ReadValues<IntCodeBigIntPolicy>(input, &value, 1))
+			{
+				return false;
+			}
+
+			values.push_back(std::move(value));
+		}
+
+		return true;
+	}
+
+	void WriteValues(std::ostream& output, std::span<const IntCodeValue> values)
+	{
+		IntCodeSnapshot::WriteInteger(output, values.size());
+		IntCodeSnapshot::WriteValues<IntCodeBigIntPolicy>(output, values.data(), values.size());
+	}
+}
+
+IntCodeResultCache& IntCodeResultCache::Get()
+{
+	static IntCodeResultCache ms_Cache;
+	return ms_Cache;
+}
+
+IntCodeResultCache::IntCodeResultCache()
+{
+	if (const char* directory = std::getenv("INTCODE_CACHE_DIRECTORY"); directory != nullptr && *directory != '\0')
+	{
+		SetDirectory(directory);
+	}
+}
+
+void IntCodeResultCache::SetDirectory(const std::filesystem::path& directory)
+{
+	m_Directory.clear();
+	if (directory.empty())
+	{
+		return;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (error)
+	{
+		std::cerr << "Can't cache IntCode results in " << directory << ": " << error.message() << std::endl;
+		return;
+	}
+
+	m_Directory = directory;
+}
+
+bool IntCodeResultCache::TryLoad(const IntCodeProgramImage& image, std::span<const IntCodeValue> inputs, std::vector<IntCodeValue>& outputs) const
+{
+	// Hits don't run any computer, which would leave nothing to record
+	if (!IsEnabled() || IntCodeTraceRecorder::Get().IsEnabled())
+	{
+		return false;
+	}
+
+	std::ifstream input(GetPath(image, inputs), std::ios::binary);
+	if (!input.is_open())
+	{
+		return false;
+	}
+
+	std::uint64_t magic = 0, byteOrderMark = 0, imageHash = 0, imageSize = 0;
+	if (!IntCodeSnapshot::ReadInteger(input, magic) || !IntCodeSnapshot::ReadInteger(input, byteOrderMark) || magic != Magic || byteOrderMark != ByteOrderMark)
+	{
+		return false;
+	}
+
+	if (!IntCodeSnapshot::ReadInteger(input, imageHash) || !IntCodeSnapshot::ReadInteger(input, imageSize) || imageHash != image.GetHash() || imageSize != image.GetSize())
+	{
+		return false;
+	}
+
+	// The file name only holds a hash of the inputs
+	std::vector<IntCodeValue> storedInputs;
+	if (!ReadValues(input, storedInputs) || !std::equal(storedInputs.begin(), storedInputs.end(), inputs.begin(), inputs.end()))
+	{
+		return false;
+	}
+
+	return ReadValues(input, outputs);
+}
+
+void IntCodeResultCache::Store(const IntCodeProgramImage& image, std::span<const IntCodeValue> inputs, std::span<const IntCodeValue> outputs)
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	const std::filesystem::path path = GetPath(image, inputs);
+
+	// Unique among the threads of this process, and (very likely) among processes
+	static const std::uint64_t ms_ProcessId = std::random_device()() * 0x1'0000'0000ull + std::random_device()();
+	std::ostringstream temporaryName;
+	temporaryName << path.filename().string() << "." << std::hex << ms_ProcessId << "-" << m_TemporaryCount++ << ".tmp";
+	const std::filesystem::path temporaryPath = m_Directory / temporaryName.str();
+
+	std::error_code error;
+	{
+		std::ofstream output(temporaryPath, std::ios::binary);
+		IntCodeSnapshot::WriteInteger(output, Magic);
+		IntCodeSnapshot::WriteInteger(output, ByteOrderMark);
+		IntCodeSnapshot::WriteInteger(output, image.GetHash());
+		IntCodeSnapshot::WriteInteger(output, image.GetSize());
+		WriteValues(output, inputs);
+		WriteValues(output, outputs);
+
+		if (!output.flush())
+		{
+			std::cerr << "Can't write IntCode result " << temporaryPath << std::endl;
+			output.close();
+			std::filesystem::remove(temporaryPath, error);
+			return;
+		}
+	}
+
+	// Whoever renames last wins, with the same content anyway
+	std::filesystem::rename(temporaryPath, path, error);
+	if (error)
+	{
+		std::cerr << "Can't store IntCode result " << path << ": " << error.message() << std::endl;
+		std::filesystem::remove(temporaryPath, error);
+	}
+}
+
+std::filesystem::path IntCodeResultCache::GetPath(const IntCodeProgramImage& image, std::span<const IntCodeValue> inputs) const
+{
+	std::ostringstream fileName;
+	fileName << std::hex << image.GetHash() << "-" << IntCodeProgramImage::ComputeHash(IntCodeProgram(inputs.begin(), inputs.end())) << ".result";
+	return m_Directory / fileName.str();
+}
@@ -0,0 +1,98 @@
+#include <IntcodeSnapshot.h>
+
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+	// "ICSNAP" and the format version
+	constexpr std::uint64_t Magic = 0x4943'534E'4150'0001ull;
+	constexpr std::uint64_t ByteOrderMark = 0x0102'0304'0506'0708ull;
+
+	// Anything bigger is a corrupted snapshot, not a value
+	constexpr std::uint64_t MaxBigIntBytes = std::uint64_t(1) << 32;
+	constexpr std::uint64_t ReadChunkBytes = 4096;
+}
+
+void IntCodeSnapshot::WriteHeader(std::ostream& output, const Header& header)
+{
+	WriteInteger(output, Magic);
+	WriteInteger(output, ByteOrderMark);
+	WriteInteger(output, static_cast<std::uint64_t>(header.m_ValueKind));
+	WriteInteger(output, header.m_ImageHash);
+	WriteInteger(output, header.m_ImageSize);
+}
+
+bool IntCodeSnapshot::ReadHeader(std::istream& input, Header& header)
+{
+	std::uint64_t magic = 0, byteOrderMark = 0, valueKind = 0;
+	if (!ReadInteger(input, magic) || !ReadInteger(input, byteOrderMark) || magic != Magic || byteOrderMark != ByteOrderMark)
+	{
+		return false;
+	}
+
+	if (!ReadInteger(input, valueKind) || valueKind > static_cast<std::uint64_t>(ValueKind::BigInt))
+	{
+		return false;
+	}
+
+	header.m_ValueKind = static_cast<ValueKind>(valueKind);
+	return ReadInteger(input, header.m_ImageHash) && ReadInteger(input, header.m_ImageSize);
+}
+
+void IntCodeSnapshot::WriteInteger(std::ostream& output, std::uint64_t value)
+{
+	output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool IntCodeSnapshot::ReadInteger(std::istream& input, std::uint64_t& value)
+{
+	return static_cast<bool>(input.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+void IntCodeSnapshot::WriteBigInt(std::ostream& output, const IntCodeValue& value)
+{
+	std::vector<unsigned char> magnitude;
+	if (value != 0)
+	{
+		boost::multiprecision::export_bits(IntCodeValue(boost::multiprecision::abs(value)), std::back_inserter(magnitude), 8);
+	}
+
+	WriteInteger(output, value < 0 ? 1 : 0);
+	WriteInteger(output, magnitude.size());
+	output.write(reinterpret_cast<const char*>(magnitude.data()), magnitude.size());
+}
+
+bool IntCodeSnapshot::ReadBigInt(std::istream& input, IntCodeValue& value)
+{
+	std::uint64_t isNegative = 0, byteCount = 0;
+	if (!ReadInteger(input, isNegative) || !ReadInteger(input, byteCount) || byteCount > MaxBigIntBytes)
+	{
+		return false;
+	}
+
+	// Grown as the bytes come: a corrupted count mustn't allocate anything big up front
+	std::vector<unsigned char> magnitude;
+	while (magnitude.size() < byteCount)
+	{
+		const std::size_t offset = magnitude.size();
+		magnitude.resize(offset + std::min<std::uint64_t>(ReadChunkBytes, byteCount - offset));
+		if (!input.read(reinterpret_cast<char*>(magnitude.data() + offset), magnitude.size() - offset))
+		{
+			return false;
+		}
+	}
+
+	value = 0;
+	if (!magnitude.empty())
+	{
+		boost::multiprecision::import_bits(value, magnitude.begin(), magnitude.end(), 8);
+	}
+
+	if (isNegative)
+	{
+		value = -value;
+	}
+
+	return true;
+}
@@ -0,0 +1,444 @@
+#include <IntcodeSymbolicExecutor.h>
+
+#include <algorithm>
+
+IntCodeExpressionGraph::NodeId IntCodeExpressionGraph::MakeConstant(const IntCodeValue& value)
+{
+	const auto it = m_Constants.find(value);
+	if (it != m_Constants.end())
+	{
+		return it->second;
+	}
+
+	const NodeId node = AddNode({ NodeKind::Constant, {}, value });
+	m_Constants.insert({ value, node });
+	return node;
+}
+
+IntCodeExpressionGraph::NodeId IntCodeExpressionGraph::MakeSymbol(std::uint32_t index)
+{
+	const auto it = m_Symbols.find(index);
+	if (it != m_Symbols.end())
+	{
+		return it->second;
+	}
+
+	const NodeId node = AddNode({ NodeKind::Symbol, { index, 0 }, 0 });
+	m_Symbols.insert({ index, node });
+	m_SymbolCount = std::max(m_SymbolCount, index + 1);
+	return node;
+}
+
+IntCodeExpressionGraph::NodeId IntCodeExpressionGraph::MakeUnknown()
+{
+	// Never shared: two unknowns are not the same value
+	return AddNode({ NodeKind::Unknown, {}, 0 });
+}
+
+IntCodeExpressionGraph::NodeId IntCodeExpressionGraph::MakeOperation(NodeKind kind, NodeId lhs, NodeId rhs)
+{
+	IntCodeValue lhsValue, rhsValue;
+	bool isLhsConstant = IsConstant(lhs, lhsValue);
+	bool isRhsConstant = IsConstant(rhs, rhsValue);
+
+	if (isLhsConstant && isRhsConstant)
+	{
+		switch (kind)
+		{
+		case NodeKind::Add: return MakeConstant(lhsValue + rhsValue);
+		case NodeKind::Multiply: return MakeConstant(lhsValue * rhsValue);
+		case NodeKind::LessThan: return MakeConstant(lhsValue < rhsValue ? 1 : 0);
+		case NodeKind::Equals:
+		default:
+			return MakeConstant(lhsValue == rhsValue ? 1 : 0);
+		}
+	}
+
+	// Constants go right, and operands of commutative operations in order
+	if (kind != NodeKind::LessThan && (isLhsConstant || (!isRhsConstant && lhs > rhs)))
+	{
+		std::swap(lhs, rhs);
+		std::swap(lhsValue, rhsValue);
+		std::swap(isLhsConstant, isRhsConstant);
+	}
+
+	if (isRhsConstant)
+	{
+		if ((kind == NodeKind::Add && rhsValue == 0) || (kind == NodeKind::Multiply && rhsValue == 1))
+		{
+			return lhs;
+		}
+
+		if (kind == NodeKind::Multiply && rhsValue == 0)
+		{
+			return rhs;
+		}
+
+		// (x + 1) + 2 is x + 3
+		IntCodeValue innerValue;
+		const Node& lhsNode = m_Nodes[lhs];
+		if ((kind == NodeKind::Add || kind == NodeKind::Multiply) && lhsNode.m_Kind == kind && IsConstant(lhsNode.m_Operands[1], innerValue))
+		{
+			const NodeId inner = lhsNode.m_Operands[0];
+			const IntCodeValue folded = kind == NodeKind::Add ? IntCodeValue(innerValue + rhsValue) : IntCodeValue(innerValue * rhsValue);
+			return MakeOperation(kind, inner, MakeConstant(folded));
+		}
+	}
+
+	if (lhs == rhs && (kind == NodeKind::LessThan || kind == NodeKind::Equals))
+	{
+		return MakeConstant(kind == NodeKind::Equals ? 1 : 0);
+	}
+
+	const auto key = std::make_tuple(kind, lhs, rhs);
+	const auto it = m_Operations.find(key);
+	if (it != m_Operations.end())
+	{
+		return it->second;
+	}
+
+	const NodeId node = AddNode({ kind, { lhs, rhs }, 0 });
+	m_Operations.insert({ key, node });
+	return node;
+}
+
+bool IntCodeExpressionGraph::IsConstant(NodeId node, IntCodeValue& value) const
+{
+	if (m_Nodes[node].m_Kind != NodeKind::Constant)
+	{
+		return false;
+	}
+
+	value = m_Nodes[node].m_Value;
+	return true;
+}
+
+bool IntCodeExpressionGraph::TryEvaluate(NodeId node, std::span<const IntCodeValue> symbols, IntCodeValue& value) const
+{
+	std::map<NodeId, IntCodeValue> values;
+	for (NodeId reachable : GetReachableNodes(node))
+	{
+		const Node& current = m_Nodes[reachable];
+		switch (current.m_Kind)
+		{
+		case NodeKind::Constant:
+			values[reachable] = current.m_Value;
+			break;
+		case NodeKind::Symbol:
+			if (current.m_Operands[0] >= symbols.size())
+			{
+				return false;
+			}
+			values[reachable] = symbols[current.m_Operands[0]];
+			break;
+		case NodeKind::Unknown:
+			return false;
+		default:
+		{
+			const IntCodeValue& lhs = values.at(current.m_Operands[0]);
+			const IntCodeValue& rhs = values.at(current.m_Operands[1]);
+			switch (current.m_Kind)
+			{
+			case NodeKind::Add: values[reachable] = lhs + rhs; break;
+			case NodeKind::Multiply: values[reachable] = lhs * rhs; break;
+			case NodeKind::LessThan: values[reachable] = lhs < rhs ? 1 : 0; break;
+			case NodeKind::Equals:
+			default:
+				values[reachable] = lhs == rhs ? 1 : 0;
+				break;
+			}
+			break;
+		}
+		}
+	}
+
+	value = values.at(node);
+	return true;
+}
+
+bool IntCodeExpressionGraph::TryExpand(NodeId node, Polynomial& polynomial, std::size_t maxTerms) const
+{
+	std::map<NodeId, Polynomial> polynomials;
+	for (NodeId reachable : GetReachableNodes(node))
+	{
+		const Node& current = m_Nodes[reachable];
+		Polynomial& result = polynomials[reachable];
+		switch (current.m_Kind)
+		{
+		case NodeKind::Constant:
+			if (current.m_Value != 0)
+			{
+				result[Monomial(m_SymbolCount, 0)] = current.m_Value;
+			}
+			break;
+		case NodeKind::Symbol:
+		{
+			Monomial monomial(m_SymbolCount, 0);
+			monomial[current.m_Operands[0]] = 1;
+			result[monomial] = 1;
+			break;
+		}
+		case NodeKind::Add:
+			result = polynomials.at(current.m_Operands[0]);
+			for (const auto& [monomial, coefficient] : polynomials.at(current.m_Operands[1]))
+			{
+				if ((result[monomial] += coefficient) == 0)
+				{
+					result.erase(monomial);
+				}
+			}
+			break;
+		case NodeKind::Multiply:
+			for (const auto& [lhsMonomial, lhsCoefficient] : polynomials.at(current.m_Operands[0]))
+			{
+				for (const auto& [rhsMonomial, rhsCoefficient] : polynomials.at(current.m_Operands[1]))
+				{
+					Monomial monomial = lhsMonomial;
+					for (std::size_t i = 0; i < monomial.size(); i++)
+					{
+						monomial[i] += rhsMonomial[i];
+					}
+
+					if ((result[monomial] += lhsCoefficient * rhsCoefficient) == 0)
+					{
+						result.erase(monomial);
+					}
+				}
+			}
+			break;
+		default:
+			return false;
+		}
+
+		if (result.size() > maxTerms)
+		{
+			return false;
+		}
+	}
+
+	polynomial = std::move(polynomials.at(node));
+	return true;
+}
+
+void IntCodeExpressionGraph::Write(std::ostream& output, NodeId node) const
+{
+	const Node& current = m_Nodes[node];
+	switch (current.m_Kind)
+	{
+	case NodeKind::Constant: output << current.m_Value; return;
+	case NodeKind::Symbol: output << "s" << current.m_Operands[0]; return;
+	case NodeKind::Unknown: output << "?"; return;
+	default:
+		break;
+	}
+
+	const char* operatorName = current.m_Kind == NodeKind::Add ? " + " : current.m_Kind == NodeKind::Multiply ? " * " : current.m_Kind == NodeKind::LessThan ? " < " : " == ";
+	output << "(";
+	Write(output, current.m_Operands[0]);
+	output << operatorName;
+	Write(output, current.m_Operands[1]);
+	output << ")";
+}
+
+IntCodeExpressionGraph::NodeId IntCodeExpressionGraph::AddNode(Node node)
+{
+	m_Nodes.push_back(std::move(node));
+	return static_cast<NodeId>(m_Nodes.size() - 1);
+}
+
+std::vector<IntCodeExpressionGraph::NodeId> IntCodeExpressionGraph::GetReachableNodes(NodeId node) const
+{
+	std::vector<bool> isReachable(node + 1, false);
+	isReachable[node] = true;
+
+	// Operands always come first: one pass downwards finds them all
+	std::vector<NodeId> reachableNodes;
+	for (NodeId current = node + 1; current-- > 0;)
+	{
+		if (!isReachable[current])
+		{
+			continue;
+		}
+
+		reachableNodes.push_back(current);
+		const Node& currentNode = m_Nodes[current];
+		if (currentNode.m_Kind != NodeKind::Constant && currentNode.m_Kind != NodeKind::Symbol && currentNode.m_Kind != NodeKind::Unknown)
+		{
+			isReachable[currentNode.m_Operands[0]] = true;
+			isReachable[currentNode.m_Operands[1]] = true;
+		}
+	}
+
+	std::reverse(reachableNodes.begin(), reachableNodes.end());
+	return reachableNodes;
+}
+
+IntCodeSymbolicExecutor::IntCodeSymbolicExecutor(const IntCodeProgram& program, std::span<const IntCodeAddress> symbolicCells)
+{
+	m_Zero = m_Graph.MakeConstant(0);
+
+	m_Memory.reserve(program.size());
+	for (const IntCodeValue& value : program)
+	{
+		m_Memory.push_back(m_Graph.MakeConstant(value));
+	}
+
+	for (std::uint32_t i = 0; i < symbolicCells.size(); i++)
+	{
+		TryStore(symbolicCells[i], m_Graph.MakeSymbol(i));
+	}
+}
+
+bool IntCodeSymbolicExecutor::Execute(std::size_t maxInstructions)
+{
+	using NodeKind = IntCodeExpressionGraph::NodeKind;
+
+	for (std::size_t count = 0; count < maxInstructions; count++)
+	{
+		IntCodeValue word;
+		if (!m_Graph.IsConstant(GetCell(m_InstructionPointer), word) || word < 0 || !IsValidOpCode((word % 100).convert_to<int>()))
+		{
+			return false;
+		}
+
+		const OpCode opCode = static_cast<OpCode>((word % 100).convert_to<int>());
+		const std::size_t parameterCount = GetParameterCount(opCode);
+
+		std::array<ParameterMode, 3> modes = {};
+		std::array<NodeId, 3> parameters = {};
+		IntCodeValue modeDigits = word / 100;
+		for (std::size_t i = 0; i < parameterCount; i++, modeDigits /= 10)
+		{
+			if (modeDigits % 10 > static_cast<int>(ParameterMode::REL))
+			{
+				return false;
+			}
+
+			modes[i] = static_cast<ParameterMode>((modeDigits % 10).convert_to<int>());
+			parameters[i] = GetCell(m_InstructionPointer + 1 + i);
+		}
+
+		switch (opCode)
+		{
+		case OpCode::ADD:
+		case OpCode::MUL:
+		case OpCode::LT_:
+		case OpCode::EQU:
+		{
+			NodeId lhs, rhs;
+			IntCodeAddress address;
+			if (!TryReadParameter(modes[0], parameters[0], lhs) || !TryReadParameter(modes[1], parameters[1], rhs) || !TryGetParameterAddress(modes[2], parameters[2], address))
+			{
+				return false;
+			}
+
+			const NodeKind kind = opCode == OpCode::ADD ? NodeKind::Add : opCode == OpCode::MUL ? NodeKind::Multiply : opCode == OpCode::LT_ ? NodeKind::LessThan : NodeKind::Equals;
+			if (!TryStore(address, m_Graph.MakeOperation(kind, lhs, rhs)))
+			{
+				return false;
+			}
+			break;
+		}
+		case OpCode::JT_:
+		case OpCode::JF_:
+		{
+			NodeId condition, target;
+			IntCodeValue conditionValue, targetValue;
+			if (!TryReadParameter(modes[0], parameters[0], condition) || !m_Graph.IsConstant(condition, conditionValue))
+			{
+				return false;
+			}
+
+			if ((conditionValue != 0) == (opCode == OpCode::JT_))
+			{
+				if (!TryReadParameter(modes[1], parameters[1], target) || !m_Graph.IsConstant(target, targetValue) || !IntCodeBigIntPolicy::TryToAddress(targetValue, m_InstructionPointer))
+				{
+					return false;
+				}
+
+				continue;
+			}
+			break;
+		}
+		case OpCode::RBS:
+		{
+			NodeId offset;
+			IntCodeValue offsetValue;
+			if (!TryReadParameter(modes[0], parameters[0], offset) || !m_Graph.IsConstant(offset, offsetValue))
+			{
+				return false;
+			}
+
+			m_RelativeBase += offsetValue;
+			break;
+		}
+		case OpCode::HLT:
+			return true;
+		case OpCode::IN_:
+		case OpCode::OU_:
+		default:
+			return false;
+		}
+
+		m_InstructionPointer += parameterCount + 1;
+	}
+
+	return false;
+}
+
+IntCodeSymbolicExecutor::NodeId IntCodeSymbolicExecutor::GetCell(IntCodeAddress address) const
+{
+	return address < m_Memory.size() ? m_Memory[address] : m_Zero;
+}
+
+bool IntCodeSymbolicExecutor::TryGetParameterAddress(ParameterMode mode, NodeId parameter, IntCodeAddress& address) const
+{
+	IntCodeValue value;
+	if (mode == ParameterMode::IMM || !m_Graph.IsConstant(parameter, value))
+	{
+		return false;
+	}
+
+	return IntCodeBigIntPolicy::TryToAddress(mode == ParameterMode::REL ? m_RelativeBase + value : value, address);
+}
+
+bool IntCodeSymbolicExecutor::TryReadParameter(ParameterMode mode, NodeId parameter, NodeId& value)
+{
+	IntCodeValue constant;
+	if (mode == ParameterMode::IMM)
+	{
+		value = parameter;
+	}
+	else if (!m_Graph.IsConstant(parameter, constant))
+	{
+		value = m_Graph.MakeUnknown();
+	}
+	else
+	{
+		IntCodeAddress address;
+		if (!TryGetParameterAddress(mode, parameter, address))
+		{
+			return false;
+		}
+
+		value = GetCell(address);
+	}
+
+	return true;
+}
+
+bool IntCodeSymbolicExecutor::TryStore(IntCodeAddress address, NodeId value)
+{
+	if (address >= MaxMemorySize)
+	{
+		return false;
+	}
+
+	if (address >= m_Memory.size())
+	{
+		m_Memory.resize(address + 1, m_Zero);
+	}
+
+	m_Memory[address] = value;
+	return true;
+}
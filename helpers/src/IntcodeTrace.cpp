@@ -0,0 +1,181 @@
+#include <IntcodeTrace.h>
+#include <IntcodeSnapshot.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	// "ICTRACE" and the format version
+	constexpr std::uint64_t Magic = 0x4943'5452'4143'4501ull;
+	constexpr std::uint64_t ByteOrderMark = 0x0102'0304'0506'0708ull;
+
+	// Anything bigger is a corrupted trace
+	constexpr std::uint64_t MaxEventCount = std::uint64_t(1) << 40;
+}
+
+IntCodeTrace::IntCodeTrace(std::uint64_t imageHash, std::uint64_t imageSize)
+	: m_ImageHash(imageHash)
+	, m_ImageSize(imageSize)
+{
+}
+
+void IntCodeTrace::Record(EventKind kind, std::uint64_t argument, const IntCodeValue& value, std::uint64_t instructionCount)
+{
+	Event& event = m_Events.emplace_back();
+	event.m_Kind = kind;
+	event.m_Argument = argument;
+	event.m_InstructionCount = instructionCount;
+	if (HasValue(kind))
+	{
+		event.m_Value = value;
+	}
+}
+
+void IntCodeTrace::Write(std::ostream& output) const
+{
+	IntCodeSnapshot::WriteInteger(output, Magic);
+	IntCodeSnapshot::WriteInteger(output, ByteOrderMark);
+	IntCodeSnapshot::WriteInteger(output, m_ImageHash);
+	IntCodeSnapshot::WriteInteger(output, m_ImageSize);
+	IntCodeSnapshot::WriteInteger(output, m_Events.size());
+
+	for (const Event& event : m_Events)
+	{
+		IntCodeSnapshot::WriteInteger(output, static_cast<std::uint64_t>(event.m_Kind));
+		IntCodeSnapshot::WriteInteger(output, event.m_Argument);
+		IntCodeSnapshot::WriteInteger(output, event.m_InstructionCount);
+		if (HasValue(event.m_Kind))
+		{
+			IntCodeSnapshot::WriteValues<IntCodeBigIntPolicy>(output, &event.m_Value, 1);
+		}
+	}
+}
+
+bool IntCodeTrace::Read(std::istream& input)
+{
+	std::uint64_t magic = 0, byteOrderMark = 0, eventCount = 0;
+	if (!IntCodeSnapshot::ReadInteger(input, magic) || !IntCodeSnapshot::ReadInteger(input, byteOrderMark) || magic != Magic || byteOrderMark != ByteOrderMark)
+	{
+		return false;
+	}
+
+	if (!IntCodeSnapshot::ReadInteger(input, m_ImageHash) || !IntCodeSnapshot::ReadInteger(input, m_ImageSize))
+	{
+		return false;
+	}
+
+	if (!IntCodeSnapshot::ReadInteger(input, eventCount) || eventCount > MaxEventCount)
+	{
+		return false;
+	}
+
+	m_Events.clear();
+	for (std::uint64_t i = 0; i < eventCount; i++)
+	{
+		std::uint64_t kind = 0;
+		Event event;
+		if (!IntCodeSnapshot::ReadInteger(input, kind) || kind > static_cast<std::uint64_t>(EventKind::ExecuteUntilAccess))
+		{
+			return false;
+		}
+
+		event.m_Kind = static_cast<EventKind>(kind);
+		if (!IntCodeSnapshot::ReadInteger(input, event.m_Argument) || !IntCodeSnapshot::ReadInteger(input, event.m_InstructionCount))
+		{
+			return false;
+		}
+
+		if (HasValue(event.m_Kind) && !IntCodeSnapshot::ReadValues<IntCodeBigIntPolicy>(input, &event.m_Value, 1))
+		{
+			return false;
+		}
+
+		m_Events.push_back(std::move(event));
+	}
+
+	return true;
+}
+
+std::uint64_t IntCodeTrace::GetExecutedInstructionCount() const
+{
+	// Counts only go down on resets
+	std::uint64_t executed = 0;
+	std::uint64_t previousCount = 0;
+	for (const Event& event : m_Events)
+	{
+		if (event.m_InstructionCount > previousCount)
+		{
+			executed += event.m_InstructionCount - previousCount;
+		}
+		previousCount = event.m_InstructionCount;
+	}
+
+	return executed;
+}
+
+bool IntCodeTrace::HasValue(EventKind kind)
+{
+	switch (kind)
+	{
+	case EventKind::Store:
+	case EventKind::Load:
+	case EventKind::SetExecutionState:
+	case EventKind::Input:
+	case EventKind::Output:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+IntCodeTraceRecorder& IntCodeTraceRecorder::Get()
+{
+	static IntCodeTraceRecorder ms_Recorder;
+	return ms_Recorder;
+}
+
+IntCodeTraceRecorder::IntCodeTraceRecorder()
+{
+	if (const char* directory = std::getenv("INTCODE_TRACE_DIRECTORY"); directory != nullptr && *directory != '\0')
+	{
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+		if (error)
+		{
+			std::cerr << "Can't record IntCode traces in " << directory << ": " << error.message() << std::endl;
+			return;
+		}
+
+		m_Directory = directory;
+	}
+}
+
+IntCodeTracePtr IntCodeTraceRecorder::CreateTrace(IntCodeTrace trace)
+{
+	if (!IsEnabled())
+	{
+		return std::make_shared<IntCodeTrace>(std::move(trace));
+	}
+
+	std::ostringstream fileName;
+	fileName << std::hex << trace.GetImageHash() << std::dec << "-" << m_TraceCount++ << ".trace";
+	const std::filesystem::path path = m_Directory / fileName.str();
+
+	return IntCodeTracePtr(new IntCodeTrace(std::move(trace)), [path](IntCodeTrace* trace)
+	{
+		if (trace->GetExecutedInstructionCount() > 0)
+		{
+			std::ofstream output(path, std::ios::binary);
+			trace->Write(output);
+			if (!output)
+			{
+				std::cerr << "Can't write IntCode trace " << path << std::endl;
+			}
+		}
+
+		delete trace;
+	});
+}
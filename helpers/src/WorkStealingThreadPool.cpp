@@ -0,0 +1,160 @@
+#include <WorkStealingThreadPool.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+	// Lets Submit know whether it's called from one of the workers, and which one
+	thread_local const WorkStealingThreadPool* tl_CurrentPool = nullptr;
+	thread_local std::size_t tl_CurrentWorker = 0;
+}
+
+WorkStealingThreadPool::WorkStealingThreadPool(std::size_t threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	for (std::size_t i = 0; i < threadCount; i++)
+	{
+		m_Queues.push_back(std::make_unique<WorkerQueue>());
+	}
+
+	for (std::size_t i = 0; i < threadCount; i++)
+	{
+		m_Threads.emplace_back([this, i]() { WorkerLoop(i); });
+	}
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_StateMutex);
+		m_IsStopping = true;
+	}
+
+	m_TaskAvailable.notify_all();
+
+	for (std::thread& thread : m_Threads)
+	{
+		thread.join();
+	}
+}
+
+void WorkStealingThreadPool::Submit(Task task)
+{
+	const std::size_t queueIndex = tl_CurrentPool == this ? tl_CurrentWorker : m_NextQueue++ % m_Queues.size();
+
+	m_UnfinishedTasks++;
+
+	{
+		// Counted under the lock, so that a worker about to sleep can't miss it.
+		// Counted before queueing, so that popping it never makes the count wrap around.
+		std::lock_guard<std::mutex> lock(m_StateMutex);
+		m_QueuedTasks++;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Queues[queueIndex]->m_Mutex);
+		m_Queues[queueIndex]->m_Tasks.push_back(std::move(task));
+	}
+
+	m_TaskAvailable.notify_one();
+}
+
+void WorkStealingThreadPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_StateMutex);
+	m_AllTasksFinished.wait(lock, [this]() { return m_UnfinishedTasks == 0; });
+
+	if (m_FirstException)
+	{
+		std::rethrow_exception(std::exchange(m_FirstException, nullptr));
+	}
+}
+
+void WorkStealingThreadPool::WorkerLoop(std::size_t workerIndex)
+{
+	tl_CurrentPool = this;
+	tl_CurrentWorker = workerIndex;
+
+	while (true)
+	{
+		Task task;
+		if (TryPopTask(workerIndex, task) || TryStealTask(workerIndex, task))
+		{
+			RunTask(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_StateMutex);
+		m_TaskAvailable.wait(lock, [this]() { return m_QueuedTasks > 0 || m_IsStopping; });
+
+		if (m_IsStopping && m_QueuedTasks == 0)
+		{
+			return;
+		}
+	}
+}
+
+bool WorkStealingThreadPool::TryPopTask(std::size_t workerIndex, Task& task)
+{
+	WorkerQueue& queue = *m_Queues[workerIndex];
+
+	std::lock_guard<std::mutex> lock(queue.m_Mutex);
+	if (queue.m_Tasks.empty())
+	{
+		return false;
+	}
+
+	task = std::move(queue.m_Tasks.back());
+	queue.m_Tasks.pop_back();
+	m_QueuedTasks--;
+	return true;
+}
+
+bool WorkStealingThreadPool::TryStealTask(std::size_t thiefIndex, Task& task)
+{
+	for (std::size_t offset = 1; offset < m_Queues.size(); offset++)
+	{
+		WorkerQueue& queue = *m_Queues[(thiefIndex + offset) % m_Queues.size()];
+
+		std::lock_guard<std::mutex> lock(queue.m_Mutex);
+		if (!queue.m_Tasks.empty())
+		{
+			task = std::move(queue.m_Tasks.front());
+			queue.m_Tasks.pop_front();
+			m_QueuedTasks--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void WorkStealingThreadPool::RunTask(Task& task)
+{
+	try
+	{
+		task();
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(m_StateMutex);
+		if (!m_FirstException)
+		{
+			m_FirstException = std::current_exception();
+		}
+	}
+
+	// Destroy whatever the task captured before declaring it finished
+	task = nullptr;
+
+	if (--m_UnfinishedTasks == 0)
+	{
+		std::lock_guard<std::mutex> lock(m_StateMutex);
+		m_AllTasksFinished.notify_all();
+	}
+}
@@ -12,6 +12,21 @@
 #include <SensorBoostSolver.h>
 #include <MonitoringStationSolver.h>
 
+#include <SensorBoostProgram.h>
+
+#include <IntcodeBatch.h>
+#include <IntcodeCompiledProgram.h>
+#include <IntcodeDisassembler.h>
+#include <IntcodeJit.h>
+#include <IntcodeNetwork.h>
+#include <IntcodeResultCache.h>
+#include <IntcodeSymbolicExecutor.h>
+#include <PermutationGenerator.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
 template<typename Solver, typename InputType, typename SolutionAType, typename SolutionBType>
 void ValidateProblem(InputType input, const SolutionAType& solutionA, const SolutionBType& solutionB)
 {
@@ -34,6 +49,25 @@ TEST_CASE("1202ProgramAlarm")
 	ValidateProblem<_1202ProgramAlarmSolver, std::string>(input, 3267740, 7870);
 }
 
+TEST_CASE("1202ProgramAlarmSearch")
+{
+	std::string input = "inputs/1202_Input.txt";
+
+	// Every pair run, like it would be for a program the symbolic solver can't follow
+	_1202ProgramAlarmSolver solver;
+	solver.Init(input);
+	solver.SetSymbolicSolvingEnabled(false);
+	REQUIRE(solver.SolveProblemB() == 7870);
+
+	// Both searches agree on another target, within a smaller space
+	solver.SetTarget(281804);
+	solver.SetSearchSpace(10, 60);
+	REQUIRE(solver.SolveProblemB() == 50);
+
+	solver.SetSymbolicSolvingEnabled(true);
+	REQUIRE(solver.SolveProblemB() == 50);
+}
+
 TEST_CASE("CrossedWires")
 {
 	constexpr const char* input = "inputs/Wires_Input.txt";
@@ -64,6 +98,78 @@ TEST_CASE("AmplificationCircuit")
 	ValidateProblem<AmplificationCircuitSolver, std::string>(input, 273814, 34579864);
 }
 
+TEST_CASE("AmplificationCircuitPhases")
+{
+	std::string input = "inputs/Amplification_Input.txt";
+
+	AmplificationCircuitSolver solver;
+	solver.Init(input);
+	solver.SetPhases({ 0, 1, 2 }, { 5, 6, 7 });
+	solver.SetThreadCount(2);
+
+	REQUIRE(solver.SolveProblemA() == 3734);
+	REQUIRE(solver.SolveProblemB() == 37086);
+}
+
+TEST_CASE("AmplificationCircuitChain")
+{
+	std::string input = "inputs/Amplification_Input.txt";
+
+	// Two amplifiers share a phase: half the permutations are the same
+	AmplificationCircuitSolver solver;
+	solver.Init(input);
+	solver.SetPhases({ 0, 1, 2, 3, 4, 0 }, { 5, 6, 7 });
+
+	REQUIRE(solver.SolveProblemA() == 1112470);
+}
+
+TEST_CASE("AmplificationCircuitOverflow")
+{
+	// Each amplifier adds its phase to the signal, three times, through products which don't fit 64 bits
+	std::string input = (std::filesystem::temp_directory_path() / "AmplificationOverflow_Input.txt").string();
+	std::ofstream(input) << "1101,3,0,102,3,100,3,101,1002,101,4611686018427387904,103,1002,101,-4611686018427387904,104,"
+		"1,103,104,105,1,101,105,101,1,101,100,101,4,101,1001,102,-1,102,1005,102,6,99";
+
+	AmplificationCircuitSolver solver;
+	solver.Init(input);
+	solver.SetPhases({ 0 }, { 5, 6 });
+
+	REQUIRE(solver.SolveProblemB() == 33);
+	std::filesystem::remove(input);
+}
+
+TEST_CASE("PermutationGenerator")
+{
+	constexpr auto CountPermutations = []()
+	{
+		FixedPermutationGenerator<int, 4> generator({ 1, 2, 3, 4 });
+
+		std::uint64_t count = 1;
+		while (generator.ComputeNextPermutation())
+		{
+			count++;
+		}
+		return count;
+	};
+	static_assert(CountPermutations() == 24);
+
+	// Walking from any rank gives the same permutations as walking from the start
+	PermutationGenerator<int> generator({ 0, 1, 2, 3, 4, 5 });
+	REQUIRE(generator.GetPermutationCount() == 720);
+
+	bool isConsistent = true;
+	for (std::uint64_t rank = 0; rank < generator.GetPermutationCount(); rank++)
+	{
+		PermutationGenerator<int> unranked({ 0, 1, 2, 3, 4, 5 });
+		unranked.Unrank(rank);
+		isConsistent &= unranked.GetCurrentPermutation() == generator.GetCurrentPermutation();
+		isConsistent &= generator.Rank() == rank;
+
+		generator.ComputeNextPermutation();
+	}
+	REQUIRE(isConsistent);
+}
+
 TEST_CASE("SpaceImageFormat")
 {
 	constexpr const char* inputFile = "inputs/SpaceImage_Input.txt";
@@ -92,4 +198,551 @@ TEST_CASE("MonitoringStation")
 {
 	constexpr const char* inputFile = "inputs/MonitoringStation_Input.txt";
 	ValidateProblem<MonitoringStationSolver, std::string>(inputFile, 253, 815);
-}
\ No newline at end of file
+}
+
+TEST_CASE("IntCodeOverflowPromotion")
+{
+	// 9223372036854775807 * 2 doesn't fit in 64 bits
+	const IntCodeProgram program = { 1102, IntCodeValue("9223372036854775807"), 2, 7, 4, 7, 99, 0 };
+	const IntCodeValue expectedOutput("18446744073709551614");
+
+	BasicIntCodeComputer<IntCodeInt64Policy> fastComputer(program);
+	fastComputer.Execute();
+	REQUIRE(fastComputer.IsOverflowed());
+
+	IntCodeComputer computer(program);
+	computer.Execute();
+
+	IntCodeValue output;
+	REQUIRE(computer.DrainOutputs(std::span(&output, 1)) == 1);
+	REQUIRE(output == expectedOutput);
+	REQUIRE(computer.IsPromoted());
+	REQUIRE(computer.IsHalted());
+}
+
+TEST_CASE("IntCodeBigValues")
+{
+	// IN x, then 10 times: ADD x x y, MUL y 3 z. Then MUL x x x in place, OUT z, OUT x, HLT
+	IntCodeProgram program = { 3, 40, 1, 40, 40, 41, 1002, 41, 3, 42, 1001, 43, 1, 43, 1007, 43, 10, 44, 1005, 44, 2, 2, 40, 40, 40, 4, 42, 4, 40, 99 };
+	program.resize(45, 0);
+
+	// Results are computed in limbs the previous ones left behind: none of them may leak into the next
+	const IntCodeValue input = boost::multiprecision::pow(IntCodeValue(7), 300);
+
+	BasicIntCodeComputer<IntCodeBigIntPolicy> computer(program);
+	REQUIRE(computer.FeedInputs(std::span(&input, 1)) == 1);
+	computer.Execute();
+	REQUIRE(computer.IsHalted());
+
+	std::array<IntCodeValue, 2> outputs;
+	REQUIRE(computer.DrainOutputs(outputs) == 2);
+	REQUIRE(outputs[0] == input * 6);
+	REQUIRE(outputs[1] == input * input);
+}
+
+TEST_CASE("IntCodeFork")
+{
+	// Reads two inputs, outputs their sum, then writes it over its own first instruction
+	const IntCodeProgram program = { 3, 11, 3, 12, 1, 11, 12, 0, 4, 0, 99, 0, 0 };
+
+	IntCodeComputer parent(program);
+	const std::array<std::int64_t, 2> inputs = { 40, 2 };
+	REQUIRE(parent.FeedInputs(inputs) == 2);
+
+	IntCodeComputer child = parent.Fork();
+	child.Execute();
+	parent.Execute();
+
+	std::int64_t childOutput = 0, parentOutput = 0;
+	REQUIRE(child.DrainOutputs(std::span(&childOutput, 1)) == 1);
+	REQUIRE(parent.DrainOutputs(std::span(&parentOutput, 1)) == 1);
+	REQUIRE(childOutput == 42);
+	REQUIRE(parentOutput == 42);
+
+	IntCodeComputer grandChild = parent.Fork();
+	grandChild.Reset();
+	REQUIRE(grandChild.GetValueAt(0) == 3);
+	REQUIRE(parent.GetValueAt(0) == 42);
+}
+
+TEST_CASE("IntCodeSparseMemory")
+{
+	// Stores 42 far beyond the directory range, then outputs it and a cell never written to
+	const IntCodeProgram program = { 1101, 40, 2, 10000000000, 4, 10000000000, 4, 5000000, 99 };
+
+	IntCodeComputer computer(program);
+	computer.Execute();
+
+	std::array<std::int64_t, 2> outputs = { -1, -1 };
+	REQUIRE(computer.DrainOutputs(outputs) == 2);
+	REQUIRE(outputs[0] == 42);
+	REQUIRE(outputs[1] == 0);
+	REQUIRE(computer.GetValueAt(10000000000) == 42);
+}
+
+TEST_CASE("IntCodeChannels")
+{
+	// Outputs twice its input, forever
+	const IntCodeProgram program = { 3, 9, 102, 2, 9, 9, 4, 9, 1105, 1, 0 };
+
+	BasicIntCodeComputer<IntCodeInt64Policy> first(program);
+	BasicIntCodeComputer<IntCodeInt64Policy> second(program);
+	second.SetInputChannel(first.GetOutputChannel());
+
+	const std::array<std::int64_t, 3> inputs = { 1, 2, 3 };
+	REQUIRE(first.FeedInputs(inputs) == 3);
+
+	first.Execute();
+	second.Execute();
+
+	// Both are waiting for more input, without having read anything bogus
+	REQUIRE(first.IsAwaitingInput());
+	REQUIRE(second.IsAwaitingInput());
+
+	std::array<std::int64_t, 4> outputs = { 0, 0, 0, 0 };
+	REQUIRE(second.DrainOutputs(outputs) == 3);
+	REQUIRE(outputs == std::array<std::int64_t, 4>{ 4, 8, 12, 0 });
+}
+
+TEST_CASE("IntCodeCoroutine")
+{
+	// Outputs the sum of its two inputs, twice
+	const IntCodeProgram program = { 3, 13, 3, 14, 1, 13, 14, 15, 4, 15, 4, 15, 99, 0, 0, 0 };
+
+	IntCodeComputer computer(program);
+	IntCodeCoroutine<IntCodeValue> routine = computer.Run();
+
+	routine.Send(40);
+	REQUIRE(!routine.Receive());
+	REQUIRE(routine.IsAwaitingInput());
+	REQUIRE(computer.IsAwaitingInput());
+
+	routine.Send(2);
+	REQUIRE(routine.Receive() == IntCodeValue(42));
+	REQUIRE(routine.Receive() == IntCodeValue(42));
+	REQUIRE(!routine.Receive());
+	REQUIRE(routine.IsDone());
+	REQUIRE(computer.IsHalted());
+}
+
+TEST_CASE("IntCodeNetwork")
+{
+	// Day 7 feedback loop example, expected to output 139629729 for phases 9, 8, 7, 6, 5
+	const IntCodeProgramImagePtr image = IntCodeProgramImage::Create({ 3, 26, 1001, 26, -4, 26, 3, 27, 1002, 27, 2, 27, 1, 27, 26, 27, 4, 27, 1001, 28, -1, 28, 1005, 28, 6, 99, 0, 0, 5 });
+
+	IntCodeTopology topology = IntCodeTopology::Ring(image, 5);
+	topology.SetInitialInputs(0, { 9, 0 });
+	topology.SetInitialInputs(1, { 8 });
+	topology.SetInitialInputs(2, { 7 });
+	topology.SetInitialInputs(3, { 6 });
+	topology.SetInitialInputs(4, { 5 });
+	topology.CollectOutputs(4);
+
+	WorkStealingThreadPool pool(4);
+	IntCodeNetwork network(topology);
+	network.Run(pool);
+
+	REQUIRE(network.IsHalted());
+	REQUIRE(network.GetCollectedOutputs(4).back() == 139629729);
+}
+
+TEST_CASE("IntCodeBatch")
+{
+	// Squares its input: IN 9, MUL 9 9 9, OUT 9, HLT
+	const IntCodeProgramImagePtr image = IntCodeProgramImage::Create({ 3, 9, 2, 9, 9, 9, 4, 9, 99, 0 });
+	const std::int64_t inputs[] = { 3, -7, 3037000500 };
+
+	for (IntCodeBatch::InstructionSet instructionSet : { IntCodeBatch::InstructionSet::Scalar, IntCodeBatch::GetBestInstructionSet() })
+	{
+		IntCodeBatch batch(image, 5, 0, instructionSet);
+		for (std::size_t i = 0; i < std::size(inputs); i++)
+		{
+			batch.FeedInputs(i, std::span(&inputs[i], 1));
+		}
+
+		// The last instance gets no input, and the one before doesn't even run the same program
+		batch.StoreValue(3, 0, 42);
+		batch.Execute();
+
+		REQUIRE(batch.GetOutputs(0) == std::vector<std::int64_t>{ 9 });
+		REQUIRE(batch.GetOutputs(1) == std::vector<std::int64_t>{ 49 });
+		REQUIRE(batch.IsOverflowed(2));
+		REQUIRE((batch.IsHalted(3) && batch.IsFaulted(3)));
+		REQUIRE(batch.GetStatus(4) == IntCodeBatch::ExecutionStatus::AwaitingInput);
+	}
+}
+
+TEST_CASE("IntCodeCompiledProgram")
+{
+	IntCodeComputer computer("inputs/Boost_Input.txt");
+	SensorBoostProgram program;
+
+	const std::int64_t input = 1;
+	computer.FeedInputs(std::span(&input, 1));
+	computer.Execute();
+	program.FeedInputs(std::span(&input, 1));
+	program.Execute();
+
+	IntCodeValue expectedOutput, output;
+	REQUIRE(computer.DrainOutputs(std::span(&expectedOutput, 1)) == 1);
+	REQUIRE(program.DrainOutputs(std::span(&output, 1)) == 1);
+	REQUIRE(output == expectedOutput);
+	REQUIRE((program.IsHalted() && !program.IsInterpreted()));
+
+	// Too big for the translated code, the interpreter takes over
+	const IntCodeValue bigInput = IntCodeValue(1) << 70;
+	computer.Reset();
+	computer.FeedInputs(std::span(&bigInput, 1));
+	computer.Execute();
+	program.Reset();
+	program.FeedInputs(std::span(&bigInput, 1));
+	program.Execute();
+
+	REQUIRE(program.IsInterpreted());
+	REQUIRE(program.GetOutputCount() == computer.GetOutputCount());
+	REQUIRE(program.DrainOutputs(std::span(&output, 1)) == 1);
+	REQUIRE(computer.DrainOutputs(std::span(&expectedOutput, 1)) == 1);
+	REQUIRE(output == expectedOutput);
+}
+
+TEST_CASE("IntCodeJit")
+{
+	const std::int64_t input = 2;
+	IntCodeComputer computer("inputs/Boost_Input.txt");
+	IntCodeComputer::FastComputer jitComputer("inputs/Boost_Input.txt");
+	jitComputer.SetJitEnabled(true);
+
+	computer.FeedInputs(std::span(&input, 1));
+	computer.Execute();
+	jitComputer.FeedInputs(std::span(&input, 1));
+	jitComputer.Execute();
+
+	std::int64_t expectedOutput, output;
+	REQUIRE(computer.DrainOutputs(std::span(&expectedOutput, 1)) == 1);
+	REQUIRE(jitComputer.DrainOutputs(std::span(&output, 1)) == 1);
+	REQUIRE(output == expectedOutput);
+	REQUIRE(jitComputer.IsJitEnabled() == IntCodeJit::IsSupported());
+	if (IntCodeJit::IsSupported())
+	{
+		REQUIRE(jitComputer.GetJit()->GetRegionCount() > 0);
+	}
+
+	// Adds 2^56 to [100] 200 times, the compiled loop overflows halfway and hands over to the interpreter
+	const std::int64_t step = std::int64_t(1) << 56;
+	IntCodeComputer overflowingComputer(IntCodeProgram{ 1101, 0, 0, 100, 1001, 100, step, 100, 1001, 101, 1, 101, 1007, 101, 200, 102, 1005, 102, 4, 4, 100, 99 });
+	overflowingComputer.SetJitEnabled(true);
+	overflowingComputer.Execute();
+
+	IntCodeValue sum;
+	REQUIRE(overflowingComputer.DrainOutputs(std::span(&sum, 1)) == 1);
+	REQUIRE(sum == IntCodeValue(200) * step);
+}
+
+TEST_CASE("IntCodeProfiler")
+{
+	ProfiledIntCodeComputer computer("inputs/Boost_Input.txt");
+
+	// No input yet: the first IN waits once
+	computer.Execute();
+	REQUIRE(computer.IsAwaitingInput());
+	REQUIRE(computer.GetProfiler().GetInputWaits() == 1);
+
+	const std::int64_t input = 1;
+	computer.FeedInputs(std::span(&input, 1));
+	computer.Execute();
+	REQUIRE(computer.IsHalted());
+
+	const IntCodeProfiler& profiler = computer.GetProfiler();
+	REQUIRE(profiler.GetOpCodeCount(IntCodeProfiler::OpCode::IN_) == 1);
+	REQUIRE(profiler.GetOpCodeCount(IntCodeProfiler::OpCode::HLT) == 1);
+
+	std::uint64_t hits = 0;
+	bool areBranchesConsistent = true;
+	profiler.ForEachAddress([&](IntCodeAddress, const IntCodeProfiler::AddressProfile& profile)
+	{
+		hits += profile.m_Hits;
+		const bool isBranch = profile.m_OpCode == IntCodeProfiler::OpCode::JT_ || profile.m_OpCode == IntCodeProfiler::OpCode::JF_;
+		areBranchesConsistent &= (isBranch ? profile.m_Hits : 0) == profile.m_TakenBranches + profile.m_UntakenBranches;
+	});
+	REQUIRE(hits == profiler.GetInstructionCount());
+	REQUIRE(areBranchesConsistent);
+
+	std::ostringstream folded;
+	profiler.WriteFoldedStacks(folded);
+	REQUIRE(folded.str().find("MUL;@0 1\n") == 0);
+}
+
+TEST_CASE("IntCodeSuperinstructions")
+{
+	// LT then JT on the cell it writes, which is the JT's own parameter: the JT must see it
+	IntCodeComputer selfModifyingComputer(IntCodeProgram{ 1107, 0, 2, 5, 1005, 5, 10, 104, 42, 99, 104, 7, 99 });
+	selfModifyingComputer.Execute();
+
+	std::int64_t output;
+	REQUIRE(selfModifyingComputer.DrainOutputs(std::span(&output, 1)) == 1);
+	REQUIRE(output == 42);
+
+	// A counter, then a MUL which overflows: the counter must not run twice after the promotion
+	IntCodeProgram program(22, 0);
+	program[0] = 1001; program[1] = 20; program[2] = 1; program[3] = 20;
+	program[4] = 1002; program[5] = 21; program[6] = 4; program[7] = 21;
+	program[8] = 4; program[9] = 21;
+	program[10] = 99;
+	program[21] = IntCodeValue(1) << 62;
+
+	IntCodeComputer overflowingComputer(program);
+	overflowingComputer.Execute();
+
+	IntCodeValue bigOutput;
+	REQUIRE(overflowingComputer.DrainOutputs(std::span(&bigOutput, 1)) == 1);
+	REQUIRE(bigOutput == IntCodeValue(1) << 64);
+	REQUIRE(overflowingComputer.GetValueAt(20) == 1);
+}
+
+TEST_CASE("IntCodeDisassembler")
+{
+	// No I/O, no write over code: always the same result
+	const IntCodeDisassembler constant(IntCodeProgram{ 1, 9, 10, 11, 2, 11, 11, 11, 99, 3, 4, 0 });
+	REQUIRE(constant.GetInstructions().size() == 3);
+	REQUIRE(constant.GetBasicBlocks().size() == 1);
+	REQUIRE(constant.GetCellKind(4) == IntCodeDisassembler::CellKind::Code);
+	REQUIRE(constant.GetCellKind(11) == IntCodeDisassembler::CellKind::Data);
+	REQUIRE(constant.IsIoFree());
+
+	// IN writes the jump target of the instruction after it
+	const IntCodeDisassembler selfModifying(IntCodeProgramImage::Parse("3,8,1001,8,10,8,105,1,0,0"));
+	REQUIRE(selfModifying.GetSelfModifyingWrites() == std::vector<IntCodeAddress>{ 0, 2 });
+	REQUIRE(selfModifying.GetIndirectJumps() == std::vector<IntCodeAddress>{ 6 });
+	REQUIRE(selfModifying.GetCellKind(8) == IntCodeDisassembler::CellKind::ModifiedCode);
+	REQUIRE(!selfModifying.IsCodeStatic());
+
+	const IntCodeDisassembler boost(IntCodeProgramRegistry::Get().Load("inputs/Boost_Input.txt")->GetProgram());
+	REQUIRE(boost.GetInputSites().size() == 1);
+	REQUIRE(!boost.GetRelativeWrites().empty());
+
+	// Every edge goes both ways
+	bool isGraphConsistent = true;
+	for (const auto& [address, block] : boost.GetBasicBlocks())
+	{
+		isGraphConsistent &= boost.FindBasicBlock(block.m_End - 1) == &block;
+		for (IntCodeAddress successor : block.m_Successors)
+		{
+			const auto& predecessors = boost.GetBasicBlocks().at(successor).m_Predecessors;
+			isGraphConsistent &= std::find(predecessors.begin(), predecessors.end(), address) != predecessors.end();
+		}
+	}
+	REQUIRE(isGraphConsistent);
+}
+
+TEST_CASE("IntCodeSymbolicExecutor")
+{
+	constexpr std::array<IntCodeAddress, 2> NounAndVerb = { 1, 2 };
+
+	IntCodeProgramImagePtr image = IntCodeProgramRegistry::Get().Load("inputs/1202_Input.txt");
+	IntCodeSymbolicExecutor executor(image->GetProgram(), NounAndVerb);
+	REQUIRE(executor.Execute());
+
+	// Same as running it, without running it
+	IntCodeComputer computer(image);
+	computer.SetNounAndVerb({ 12, 2 });
+	computer.Execute();
+
+	const std::array<IntCodeValue, 2> symbols = { 12, 2 };
+	IntCodeValue value;
+	REQUIRE(executor.GetGraph().TryEvaluate(executor.GetCell(0), symbols, value));
+	REQUIRE(value == computer.GetValueAt(0));
+
+	IntCodeExpressionGraph::Polynomial polynomial;
+	REQUIRE(executor.GetGraph().TryExpand(executor.GetCell(0), polynomial));
+	REQUIRE(polynomial.size() == 3);
+
+	// A jump on the noun can't be followed
+	IntCodeSymbolicExecutor branching(IntCodeProgram{ 1005, 0, 0, 99 }, NounAndVerb);
+	REQUIRE(!branching.Execute());
+}
+
+TEST_CASE("IntCodeSweep")
+{
+	// [17] = (2 + 3) * 5, then [0] = [17] + [18]
+	IntCodeComputer prefix(IntCodeProgram{ 1101, 2, 3, 17, 1002, 17, 5, 17, 1, 17, 18, 0, 99, 0, 0, 0, 0, 0, 0 });
+
+	const std::array<IntCodeAddress, 1> parameterCells = { 18 };
+	prefix.ExecuteUntilAccess(parameterCells);
+	REQUIRE(prefix.IsPaused());
+	REQUIRE(prefix.GetValueAt(17) == 25);
+	REQUIRE(prefix.GetValueAt(0) == 1101);
+
+	for (std::int64_t parameter : { 7, -25 })
+	{
+		IntCodeComputer computer = prefix.Fork();
+		computer.SetValueAt(18, parameter);
+		computer.Execute();
+		REQUIRE(computer.IsHalted());
+		REQUIRE(computer.GetValueAt(0) == 25 + parameter);
+	}
+}
+
+TEST_CASE("IntCodeBudget")
+{
+	// Counts down from 1000, then multiplies 4000000000000000000 by 3 (which promotes), outputs it and halts
+	IntCodeProgram program = { 1001, 20, -1, 20, 1005, 20, 0, 1002, 21, 3, 21, 4, 21, 99 };
+	program.resize(22, 0);
+	program[20] = 1000;
+	program[21] = IntCodeValue("4000000000000000000");
+
+	IntCodeComputer reference(program);
+	reference.Execute();
+	REQUIRE(reference.GetInstructionCount() == 2003);
+
+	// Slices resume exactly where the previous one stopped, across the promotion
+	IntCodeComputer computer(program);
+	computer.Execute(7);
+	REQUIRE(computer.IsPreempted());
+	REQUIRE(computer.GetInstructionCount() >= 7);
+	REQUIRE(computer.GetInstructionCount() <= 8);
+
+	while (computer.IsPreempted())
+	{
+		computer.Execute(7);
+	}
+
+	REQUIRE(computer.IsHalted());
+	REQUIRE(computer.IsPromoted());
+	REQUIRE(computer.GetInstructionCount() == 2003);
+
+	IntCodeValue output;
+	REQUIRE(computer.DrainOutputs(std::span(&output, 1)) == 1);
+	REQUIRE(output == IntCodeValue("12000000000000000000"));
+
+	IntCodeComputer deadlineComputer(program);
+	deadlineComputer.ExecuteUntil(std::chrono::steady_clock::now());
+	REQUIRE(deadlineComputer.IsHalted());
+}
+
+TEST_CASE("IntCodeSnapshot")
+{
+	// Same program as IntCodeBudget: counts down from 1000, then promotes, outputs and halts
+	IntCodeProgram program = { 1001, 20, -1, 20, 1005, 20, 0, 1002, 21, 3, 21, 4, 21, 99 };
+	program.resize(22, 0);
+	program[20] = 1000;
+	program[21] = IntCodeValue("4000000000000000000");
+
+	IntCodeComputer computer(program);
+	computer.Execute(1000);
+
+	std::stringstream snapshot;
+	computer.SaveSnapshot(snapshot);
+
+	IntCodeComputer restored(program);
+	REQUIRE(restored.LoadSnapshot(snapshot));
+	REQUIRE(restored.IsPreempted());
+	REQUIRE(restored.GetInstructionCount() == computer.GetInstructionCount());
+	REQUIRE(restored.GetValueAt(20) == computer.GetValueAt(20));
+
+	computer.Execute();
+	restored.Execute();
+	REQUIRE(restored.IsHalted());
+	REQUIRE(restored.GetInstructionCount() == computer.GetInstructionCount());
+
+	// Promoted, with its output still pending
+	std::stringstream promotedSnapshot;
+	restored.SaveSnapshot(promotedSnapshot);
+
+	IntCodeComputer promoted(program);
+	REQUIRE(promoted.LoadSnapshot(promotedSnapshot));
+	REQUIRE(promoted.IsPromoted());
+	REQUIRE(promoted.IsHalted());
+
+	IntCodeValue output;
+	REQUIRE(promoted.DrainOutputs(std::span(&output, 1)) == 1);
+	REQUIRE(output == IntCodeValue("12000000000000000000"));
+
+	// Snapshots only go to computers running the same program
+	IntCodeComputer stranger(IntCodeProgram{ 99 });
+	snapshot.seekg(0);
+	REQUIRE(!stranger.LoadSnapshot(snapshot));
+}
+
+TEST_CASE("IntCodeTrace")
+{
+	IntCodeComputer computer("inputs/Boost_Input.txt");
+	computer.SetTrace(std::make_shared<IntCodeTrace>(computer.GetImage()->GetHash(), computer.GetImage()->GetSize()));
+
+	const IntCodeValue input = 2;
+	IntCodeValue output;
+	computer.FeedInputs(std::span(&input, 1));
+	computer.Execute();
+	REQUIRE(computer.DrainOutputs(std::span(&output, 1)) == 1);
+
+	std::stringstream file;
+	computer.GetTrace()->Write(file);
+
+	IntCodeTrace trace;
+	REQUIRE(trace.Read(file));
+	REQUIRE(trace.GetImageHash() == computer.GetImage()->GetHash());
+	REQUIRE(trace.GetExecutedInstructionCount() == computer.GetInstructionCount());
+
+	// Same run on every tier
+	IntCodeComputer interpreter("inputs/Boost_Input.txt");
+	REQUIRE(trace.Replay(interpreter).IsMatching());
+
+	IntCodeComputer jitComputer("inputs/Boost_Input.txt");
+	jitComputer.SetJitEnabled(true);
+	REQUIRE(trace.Replay(jitComputer).IsMatching());
+
+	IntCodeComputer::BigComputer bigComputer("inputs/Boost_Input.txt");
+	const IntCodeTrace::ReplayResult result = trace.Replay(bigComputer);
+	REQUIRE(result.IsMatching());
+	REQUIRE(result.m_InstructionCount == computer.GetInstructionCount());
+
+	SensorBoostProgram compiled;
+	REQUIRE(trace.Replay(compiled).IsMatching());
+
+	// Another program doesn't give the recorded output
+	IntCodeComputer stranger("inputs/Sunny_Input.txt");
+	REQUIRE(trace.Replay(stranger).m_FirstMismatch == trace.GetEvents().size() - 1);
+}
+
+TEST_CASE("IntCodeResultCache")
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "IntCodeResultCacheTest";
+	std::filesystem::remove_all(directory);
+
+	IntCodeResultCache& cache = IntCodeResultCache::Get();
+	cache.SetDirectory(directory);
+
+	IntCodeProgramImagePtr image = IntCodeProgramImage::Create({ 3, 0, 4, 0, 99 });
+	const IntCodeValue inputs[] = { 5 };
+
+	std::size_t runCount = 0;
+	const auto run = [&](std::vector<IntCodeValue>& outputs) { runCount++; outputs = { 42, 7 }; return true; };
+	REQUIRE(cache.GetOrRun(*image, inputs, run) == std::vector<IntCodeValue>{ 42, 7 });
+	REQUIRE(cache.GetOrRun(*image, inputs, run) == std::vector<IntCodeValue>{ 42, 7 });
+	REQUIRE(runCount == 1);
+
+	// Other inputs, or another program, miss
+	std::vector<IntCodeValue> outputs;
+	const IntCodeValue otherInputs[] = { 5, 1 };
+	REQUIRE(!cache.TryLoad(*image, otherInputs, outputs));
+	REQUIRE(!cache.TryLoad(*IntCodeProgramImage::Create({ 99 }), inputs, outputs));
+
+	// So does a result claiming more outputs than it holds (after the header and the input)
+	const std::filesystem::path result = std::filesystem::directory_iterator(directory)->path();
+	{
+		std::fstream file(result, std::ios::binary | std::ios::in | std::ios::out);
+		file.seekp(4 * sizeof(std::uint64_t) + sizeof(std::uint64_t) + 2 * sizeof(std::uint64_t) + 1);
+		const std::uint64_t outputCount = std::numeric_limits<std::uint64_t>::max();
+		file.write(reinterpret_cast<const char*>(&outputCount), sizeof(outputCount));
+	}
+	REQUIRE(!cache.TryLoad(*image, inputs, outputs));
+
+	// Real results come back the same from the cache
+	for (int i = 0; i < 2; i++)
+	{
+		ValidateProblem<SunnyWithAChanceOfAsteroidsSolver, std::string>("inputs/Sunny_Input.txt", 12896948u, 7704130u);
+		ValidateProblem<SensorBoostSolver, std::string>("inputs/Boost_Input.txt", IntCodeValue("2682107844"), IntCodeValue("34738"));
+	}
+
+	cache.SetDirectory({});
+	std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,156 @@
+#include <IntcodeProgram.h>
+#include <IntcodeTrace.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+namespace bpo = boost::program_options;
+
+namespace
+{
+	// Best of the repeated replays, or the first that didn't match
+	template<typename Computer>
+	IntCodeTrace::ReplayResult Replay(const IntCodeTrace& trace, Computer& computer, std::size_t repeatCount)
+	{
+		IntCodeTrace::ReplayResult best = trace.Replay(computer);
+		for (std::size_t i = 1; i < repeatCount && best.IsMatching(); i++)
+		{
+			IntCodeTrace::ReplayResult result = trace.Replay(computer);
+			if (!result.IsMatching() || result.m_Duration < best.m_Duration)
+			{
+				best = result;
+			}
+		}
+
+		return best;
+	}
+
+	bool ReplayOnTier(const IntCodeTrace& trace, const IntCodeProgramImagePtr& image, const std::string& tier, std::size_t repeatCount, IntCodeTrace::ReplayResult& result)
+	{
+		if (tier == "interpreter" || tier == "jit")
+		{
+			IntCodeComputer computer(image);
+			computer.SetJitEnabled(tier == "jit");
+			result = Replay(trace, computer, repeatCount);
+		}
+		else if (tier == "bigint")
+		{
+			IntCodeComputer::BigComputer computer(image);
+			result = Replay(trace, computer, repeatCount);
+		}
+		else if (tier == "profiled")
+		{
+			ProfiledIntCodeComputer computer(image);
+			result = Replay(trace, computer, repeatCount);
+		}
+		else
+		{
+			std::cerr << "Unknown tier " << tier << ", expected interpreter, jit, bigint or profiled" << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bpo::options_description optionsDescription("Allowed options");
+	optionsDescription.add_options()
+		("program,p", bpo::value<std::string>(), "IntCode program the traces were recorded from")
+		("trace,t", bpo::value<std::string>(), "Trace to replay, or directory of traces (only those of the program are replayed)")
+		("tier,e", bpo::value<std::vector<std::string>>()->multitoken()->default_value({ "interpreter", "jit" }, "interpreter jit"), "Computers to replay on: interpreter, jit, bigint, profiled")
+		("repeat,r", bpo::value<std::size_t>()->default_value(1), "Replays of each trace, the fastest counts");
+
+	bpo::variables_map varMap;
+	bpo::store(bpo::parse_command_line(argc, argv, optionsDescription), varMap);
+	bpo::notify(varMap);
+
+	if (!varMap.count("program") || !varMap.count("trace"))
+	{
+		std::cerr << "Missing program or trace argument" << std::endl;
+		std::cout << optionsDescription << std::endl;
+		return 1;
+	}
+
+	const std::string programPath = varMap["program"].as<std::string>();
+	IntCodeProgramImagePtr image = IntCodeProgramRegistry::Get().Load(programPath);
+	if (image->IsEmpty())
+	{
+		std::cerr << "Error: couldn't process input file " << programPath << std::endl;
+		return 1;
+	}
+
+	const std::filesystem::path tracePath = varMap["trace"].as<std::string>();
+	std::vector<std::filesystem::path> tracePaths;
+	if (std::filesystem::is_directory(tracePath))
+	{
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(tracePath))
+		{
+			if (entry.path().extension() == ".trace")
+			{
+				tracePaths.push_back(entry.path());
+			}
+		}
+		std::sort(tracePaths.begin(), tracePaths.end());
+	}
+	else
+	{
+		tracePaths.push_back(tracePath);
+	}
+
+	bool isMatching = true;
+	const std::size_t repeatCount = std::max<std::size_t>(varMap["repeat"].as<std::size_t>(), 1);
+	for (const std::filesystem::path& path : tracePaths)
+	{
+		IntCodeTrace trace;
+		std::ifstream input(path, std::ios::binary);
+		if (!trace.Read(input))
+		{
+			std::cerr << "Error: " << path << " isn't an IntCode trace" << std::endl;
+			return 1;
+		}
+
+		if (trace.GetImageHash() != image->GetHash() || trace.GetImageSize() != image->GetSize())
+		{
+			// Expected when going through a directory of traces from several programs
+			if (tracePaths.size() == 1)
+			{
+				std::cerr << "Error: " << path << " wasn't recorded from " << programPath << std::endl;
+				return 1;
+			}
+			continue;
+		}
+
+		for (const std::string& tier : varMap["tier"].as<std::vector<std::string>>())
+		{
+			IntCodeTrace::ReplayResult result;
+			if (!ReplayOnTier(trace, image, tier, repeatCount, result))
+			{
+				return 1;
+			}
+
+			std::cout << path.filename().string() << " on " << tier << ": ";
+			if (result.IsMatching())
+			{
+				std::cout << result.m_InstructionCount << " instructions in " << result.m_Duration.count() * 1000.0 << " ms, "
+					<< result.GetInstructionsPerSecond() / 1e6 << " M instructions/s" << std::endl;
+			}
+			else
+			{
+				const IntCodeTrace::Event& event = trace.GetEvents()[result.m_FirstMismatch];
+				std::cout << "MISMATCH at event " << result.m_FirstMismatch << " (kind " << static_cast<std::uint64_t>(event.m_Kind)
+					<< ", after " << event.m_InstructionCount << " instructions)" << std::endl;
+				isMatching = false;
+			}
+		}
+	}
+
+	return isMatching ? 0 : 1;
+}
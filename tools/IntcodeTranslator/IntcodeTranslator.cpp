@@ -0,0 +1,268 @@
+#include <IntcodeTranslator.h>
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+	// Leaves the native code, resuming at the given instruction
+	std::string Exit(const std::string& instructionPointer, const char* exit)
+	{
+		return "{ m_InstructionPointer = " + instructionPointer + "; m_RelativeBase = relativeBase; return NativeExit::" + exit + "; }";
+	}
+
+	std::string Exit(std::int64_t instructionPointer, const char* exit)
+	{
+		return Exit(std::to_string(instructionPointer), exit);
+	}
+}
+
+IntCodeTranslator::IntCodeTranslator(const IntCodeProgram& program, std::size_t memorySize)
+	: m_MemorySize(std::max(memorySize, program.size()))
+	, m_Disassembler(program)
+{
+	for (const IntCodeValue& bigValue : program)
+	{
+		std::int64_t value;
+		if (!IntCodeInt64Policy::TryFromBigInt(bigValue, value))
+		{
+			std::cerr << "Error: " << bigValue << " doesn't fit in 64 bits, the program can't be translated" << std::endl;
+			m_Program.clear();
+			return;
+		}
+
+		m_Program.push_back(value);
+	}
+}
+
+std::int64_t IntCodeTranslator::GetParameter(const Instruction& instruction, std::size_t index)
+{
+	return instruction.m_Parameters[index].convert_to<std::int64_t>();
+}
+
+bool IntCodeTranslator::IsKnownInstruction(std::int64_t address) const
+{
+	return address >= 0 && m_Disassembler.FindInstruction(static_cast<IntCodeAddress>(address)) != nullptr;
+}
+
+void IntCodeTranslator::WriteHeader(std::ostream& output, const std::string& className, const std::string& sourceName) const
+{
+	output << "#pragma once\n";
+	output << "\n";
+	output << "// Generated by IntcodeTranslator from " << sourceName << ", do not edit\n";
+	output << "\n";
+	output << "#include <IntcodeCompiledProgram.h>\n";
+	output << "\n";
+	output << "class " << className << " final : public IntCodeCompiledProgram\n";
+	output << "{\n";
+	output << "public:\n";
+	output << "\t// IntCodeProgramImage::GetHash of the translated program\n";
+	output << "\tstatic constexpr std::uint64_t ImageHash = " << IntCodeProgramImage::ComputeHash(IntCodeProgram(m_Program.begin(), m_Program.end())) << "ull;\n";
+	output << "\tstatic constexpr std::size_t ProgramSize = " << m_Program.size() << ";\n";
+	output << "\tstatic constexpr std::size_t MemorySize = " << m_MemorySize << ";\n";
+	output << "\n";
+	output << "\t" << className << "();\n";
+	output << "\n";
+	output << "private:\n";
+	output << "\tNativeExit RunNative() override;\n";
+	output << "};\n";
+}
+
+void IntCodeTranslator::WriteSource(std::ostream& output, const std::string& className, const std::string& sourceName) const
+{
+	constexpr std::size_t ValuesPerLine = 20;
+
+	output << "// Generated by IntcodeTranslator from " << sourceName << ", do not edit\n";
+	output << "\n";
+	output << "#include <" << className << ".h>\n";
+	output << "\n";
+	output << "namespace\n";
+	output << "{\n";
+	output << "\tconstexpr std::int64_t s_Program[] =\n\t{";
+	for (std::size_t i = 0; i < m_Program.size(); i++)
+	{
+		output << (i % ValuesPerLine == 0 ? "\n\t\t" : " ") << m_Program[i] << ",";
+	}
+	output << "\n\t};\n";
+	output << "\n";
+	output << "\tconstexpr bool s_IsCode[] =\n\t{";
+	for (std::size_t i = 0; i < m_Program.size(); i++)
+	{
+		output << (i % ValuesPerLine == 0 ? "\n\t\t" : " ") << (m_Disassembler.IsCode(i) ? "1," : "0,");
+	}
+	output << "\n\t};\n";
+	output << "}\n";
+	output << "\n";
+	output << className << "::" << className << "()\n";
+	output << "\t: IntCodeCompiledProgram(s_Program, s_IsCode, MemorySize)\n";
+	output << "{\n";
+	output << "}\n";
+	output << "\n";
+	output << "IntCodeCompiledProgram::NativeExit " << className << "::RunNative()\n";
+	output << "{\n";
+	output << "\tstd::int64_t* const memory = m_Memory.data();\n";
+	output << "\tstd::int64_t relativeBase = m_RelativeBase;\n";
+	output << "\tstd::int64_t instructionPointer = m_InstructionPointer;\n";
+	output << "\t[[maybe_unused]] std::int64_t operand0 = 0, operand1 = 0, result = 0;\n";
+	output << "\n";
+	output << "dispatch:\n";
+	output << "\tswitch (instructionPointer)\n";
+	output << "\t{\n";
+	const auto& instructions = m_Disassembler.GetInstructions();
+	for (const auto& [address, instruction] : instructions)
+	{
+		output << "\tcase " << address << ": goto i" << address << ";\n";
+	}
+	output << "\tdefault: " << Exit("instructionPointer", "Interpret") << "\n";
+	output << "\t}\n";
+
+	for (auto it = instructions.begin(); it != instructions.end(); ++it)
+	{
+		const auto& [address, instruction] = *it;
+
+		output << "\n";
+		WriteInstruction(output, address, instruction);
+
+		if (instruction.m_OpCode == OpCode::HLT)
+		{
+			continue;
+		}
+
+		const std::size_t next = address + instruction.m_Length;
+		const auto nextIt = std::next(it);
+		if (nextIt == instructions.end() || nextIt->first != next)
+		{
+			output << "\t" << (IsKnownInstruction(next) ? "goto i" + std::to_string(next) + ";" : Exit(next, "Interpret")) << "\n";
+		}
+	}
+
+	output << "}\n";
+}
+
+void IntCodeTranslator::WriteInstruction(std::ostream& output, std::size_t address, const Instruction& instruction) const
+{
+	output << "i" << address << ": // ";
+	IntCodeDisassembler::WriteInstruction(output, instruction);
+	output << "\n";
+
+	// Fixed writes to code or past the memory always go to the interpreter
+	const std::size_t storedParameter = GetStoredParameter(instruction.m_OpCode);
+	if (storedParameter < instruction.m_Length - 1 && instruction.m_Modes[storedParameter] == ParameterMode::POS)
+	{
+		const std::int64_t target = GetParameter(instruction, storedParameter);
+		if (target < 0 || target >= static_cast<std::int64_t>(m_MemorySize) || m_Disassembler.IsCode(static_cast<IntCodeAddress>(target)))
+		{
+			output << "\t" << Exit(address, "Interpret") << "\n";
+			return;
+		}
+	}
+
+	switch (instruction.m_OpCode)
+	{
+	case OpCode::ADD:
+	case OpCode::MUL:
+	{
+		const std::string lhs = WriteRead(output, address, instruction, 0);
+		const std::string rhs = WriteRead(output, address, instruction, 1);
+		output << "\tif (!IntCodeInt64Policy::" << (instruction.m_OpCode == OpCode::ADD ? "TryAdd" : "TryMul") << "(" << lhs << ", " << rhs << ", result)) " << Exit(address, "Interpret") << "\n";
+		WriteStore(output, address, instruction, 2, "result");
+		break;
+	}
+	case OpCode::LT_:
+	case OpCode::EQU:
+	{
+		const std::string lhs = WriteRead(output, address, instruction, 0);
+		const std::string rhs = WriteRead(output, address, instruction, 1);
+		WriteStore(output, address, instruction, 2, "(" + lhs + (instruction.m_OpCode == OpCode::LT_ ? " < " : " == ") + rhs + " ? 1 : 0)");
+		break;
+	}
+	case OpCode::IN_:
+		output << "\tif (m_InputChannel->IsEmpty()) " << Exit(address, "AwaitInput") << "\n";
+		WriteStore(output, address, instruction, 0, "*m_InputChannel->Front()");
+		output << "\tm_InputChannel->PopFront();\n";
+		break;
+	case OpCode::OU_:
+	{
+		const std::string value = WriteRead(output, address, instruction, 0);
+		output << "\tif (!m_OutputChannel->TryPush(" << value << ")) " << Exit(address, "Block") << "\n";
+		break;
+	}
+	case OpCode::JT_:
+	case OpCode::JF_:
+	{
+		const std::string test = WriteRead(output, address, instruction, 0);
+		const std::string target = WriteRead(output, address, instruction, 1);
+		output << "\tif (" << test << (instruction.m_OpCode == OpCode::JT_ ? " != 0" : " == 0") << ") ";
+		WriteJump(output, target, instruction.m_Modes[1] == ParameterMode::IMM, GetParameter(instruction, 1));
+		output << "\n";
+		break;
+	}
+	case OpCode::RBS:
+	{
+		const std::string offset = WriteRead(output, address, instruction, 0);
+		output << "\tif (!IntCodeInt64Policy::TryAdd(relativeBase, " << offset << ", result)) " << Exit(address, "Interpret") << "\n";
+		output << "\trelativeBase = result;\n";
+		break;
+	}
+	case OpCode::HLT:
+	default:
+		output << "\t" << Exit(address, "Halt") << "\n";
+		break;
+	}
+}
+
+std::string IntCodeTranslator::WriteRead(std::ostream& output, std::size_t address, const Instruction& instruction, std::size_t index) const
+{
+	const std::int64_t parameter = GetParameter(instruction, index);
+	switch (instruction.m_Modes[index])
+	{
+	case ParameterMode::IMM:
+		return std::to_string(parameter);
+	case ParameterMode::REL:
+	{
+		const std::string operand = "operand" + std::to_string(index);
+		output << "\tif (!TryRead(relativeBase, " << parameter << ", " << operand << ")) " << Exit(address, "Interpret") << "\n";
+		return operand;
+	}
+	case ParameterMode::POS:
+	default:
+		if (parameter < 0)
+		{
+			output << "\t" << Exit(address, "Interpret") << "\n";
+			return "0";
+		}
+
+		// Nothing was ever written past the memory
+		return parameter < static_cast<std::int64_t>(m_MemorySize) ? "memory[" + std::to_string(parameter) + "]" : "0";
+	}
+}
+
+void IntCodeTranslator::WriteStore(std::ostream& output, std::size_t address, const Instruction& instruction, std::size_t index, const std::string& value) const
+{
+	const std::int64_t parameter = GetParameter(instruction, index);
+	if (instruction.m_Modes[index] == ParameterMode::REL)
+	{
+		output << "\tif (!TryWrite(relativeBase, " << parameter << ", " << value << ")) " << Exit(address, "Interpret") << "\n";
+	}
+	else
+	{
+		// Already checked by WriteInstruction
+		output << "\tmemory[" << parameter << "] = " << value << ";\n";
+	}
+}
+
+void IntCodeTranslator::WriteJump(std::ostream& output, const std::string& target, bool isImmediate, std::int64_t immediateTarget) const
+{
+	if (!isImmediate)
+	{
+		output << "{ instructionPointer = " << target << "; goto dispatch; }";
+	}
+	else if (IsKnownInstruction(immediateTarget))
+	{
+		output << "goto i" << immediateTarget << ";";
+	}
+	else
+	{
+		output << Exit(immediateTarget, "Interpret");
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <IntcodeDisassembler.h>
+#include <IntcodeProgram.h>
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/***********************************************************************************************
+
+ Translates an IntCode program into a C++ class deriving from IntCodeCompiledProgram.
+
+ Every instruction IntCodeDisassembler finds becomes a few native statements on 64 bit
+ integers: jumps with a known target are gotos, the others go through a switch on every
+ instruction found. Everything the translation can't vouch for (overflows, writes to code or past the memory, jumps somewhere unknown) leaves
+ the native code for the interpreter.
+
+************************************************************************************************/
+
+class IntCodeTranslator : public IntCodeDefinitions
+{
+public:
+	// The program must fit in 64 bits
+	IntCodeTranslator(const IntCodeProgram& program, std::size_t memorySize);
+
+	inline bool IsValid() const { return !m_Program.empty(); }
+
+	void WriteHeader(std::ostream& output, const std::string& className, const std::string& sourceName) const;
+	void WriteSource(std::ostream& output, const std::string& className, const std::string& sourceName) const;
+
+	inline std::size_t GetInstructionCount() const { return m_Disassembler.GetInstructions().size(); }
+
+private:
+	using Instruction = IntCodeDisassembler::Instruction;
+
+	// Parameters fit in 64 bits, like the whole program
+	static std::int64_t GetParameter(const Instruction& instruction, std::size_t index);
+
+	void WriteInstruction(std::ostream& output, std::size_t address, const Instruction& instruction) const;
+
+	// The expression reading a parameter, after the statements it might need
+	std::string WriteRead(std::ostream& output, std::size_t address, const Instruction& instruction, std::size_t index) const;
+	void WriteStore(std::ostream& output, std::size_t address, const Instruction& instruction, std::size_t index, const std::string& value) const;
+	void WriteJump(std::ostream& output, const std::string& target, bool isImmediate, std::int64_t immediateTarget) const;
+
+	bool IsKnownInstruction(std::int64_t address) const;
+
+	std::vector<std::int64_t>				m_Program;
+	std::size_t								m_MemorySize;
+
+	IntCodeDisassembler						m_Disassembler;
+};
@@ -0,0 +1,65 @@
+#include <IntcodeTranslator.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include <boost/program_options.hpp>
+
+namespace bpo = boost::program_options;
+
+int main(int argc, char** argv)
+{
+	constexpr std::size_t DefaultMemorySize = 16384;
+
+	bpo::options_description optionsDescription("Allowed options");
+	optionsDescription.add_options()
+		("input,i", bpo::value<std::string>(), "IntCode program to translate")
+		("class,c", bpo::value<std::string>(), "Name of the generated class, and of its files")
+		("output,o", bpo::value<std::string>()->default_value("."), "Directory the files are generated in")
+		("memory,m", bpo::value<std::size_t>()->default_value(DefaultMemorySize), "Memory of the translated program, in values");
+
+	bpo::variables_map varMap;
+	bpo::store(bpo::parse_command_line(argc, argv, optionsDescription), varMap);
+	bpo::notify(varMap);
+
+	if (!varMap.count("input") || !varMap.count("class"))
+	{
+		std::cerr << "Missing input or class argument" << std::endl;
+		std::cout << optionsDescription << std::endl;
+		return 1;
+	}
+
+	const std::filesystem::path inputPath = varMap["input"].as<std::string>();
+	const std::string className = varMap["class"].as<std::string>();
+	const std::filesystem::path outputDirectory = varMap["output"].as<std::string>();
+
+	IntCodeProgramImagePtr image = IntCodeProgramRegistry::Get().Load(inputPath.string());
+	if (image->IsEmpty())
+	{
+		std::cerr << "Error: couldn't process input file " << inputPath << std::endl;
+		return 1;
+	}
+
+	IntCodeTranslator translator(image->GetProgram(), varMap["memory"].as<std::size_t>());
+	if (!translator.IsValid())
+	{
+		return 1;
+	}
+
+	std::filesystem::create_directories(outputDirectory);
+
+	std::ofstream header(outputDirectory / (className + ".h"));
+	translator.WriteHeader(header, className, inputPath.filename().string());
+
+	std::ofstream source(outputDirectory / (className + ".cpp"));
+	translator.WriteSource(source, className, inputPath.filename().string());
+
+	if (!header || !source)
+	{
+		std::cerr << "Error: couldn't write " << className << " in " << outputDirectory << std::endl;
+		return 1;
+	}
+
+	std::cout << "Translated " << translator.GetInstructionCount() << " instructions of " << inputPath.filename() << " into " << className << std::endl;
+}